@@ -13,6 +13,8 @@ public class PlayMontageAdvanced : ModuleRules
 			{
 				"Core",
 				"GameplayAbilities",
+				"NetCore",
+				"DeveloperSettings",
 			}
 			);
 			
@@ -24,7 +26,17 @@ public class PlayMontageAdvanced : ModuleRules
 				"Engine",
 				"GameplayTasks",
 				"GameplayTags",
+				"Json",
 			}
 			);
+
+		// Play sessions for the networked automation tests
+		if (Target.bBuildEditor)
+		{
+			PrivateDependencyModuleNames.AddRange(new string[] { "AssetRegistry", "UnrealEd" });
+		}
+
+		// Adds IrisCore and defines UE_WITH_IRIS when the target supports Iris
+		SetupIrisSupport(Target);
 	}
 }
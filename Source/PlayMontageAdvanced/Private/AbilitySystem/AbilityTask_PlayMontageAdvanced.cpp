@@ -1,4 +1,4 @@
-// Copyright Epic Games, Inc. All Rights Reserved.
+﻿// Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "AbilitySystem/AbilityTask_PlayMontageAdvanced.h"
 
@@ -101,7 +101,7 @@ UAbilityTask_PlayMontageAdvanced* UAbilityTask_PlayMontageAdvanced::CreatePlayMo
 	EPlayMontageAdvancedNotifyHandling NotifyHandling, bool bTriggerNotifiesBeforeStartTimeSeconds,
 	bool bDrivenMontagesMatchDriverDuration, bool bOverrideBlendIn, FMontageBlendSettings BlendInOverride,
 	bool bAllowInterruptAfterBlendOut, float OverrideBlendOutTimeOnCancelAbility,
-	float OverrideBlendOutTimeOnEndAbility)
+	float OverrideBlendOutTimeOnEndAbility, FName BlendInPreset, bool bReplicateDrivenMontagesAsGroup)
 {
 	UAbilitySystemGlobals::NonShipping_ApplyGlobalAbilityScaler_Rate(Rate);
 
@@ -145,8 +145,10 @@ UAbilityTask_PlayMontageAdvanced* UAbilityTask_PlayMontageAdvanced::CreatePlayMo
 	MyObj->NotifyHandling = NotifyHandling;
 	MyObj->bTriggerNotifiesBeforeStartTimeSeconds = bTriggerNotifiesBeforeStartTimeSeconds;
 	MyObj->bDrivenMontagesMatchDriverDuration = bDrivenMontagesMatchDriverDuration;
+	MyObj->bReplicateDrivenMontagesAsGroup = bReplicateDrivenMontagesAsGroup;
 	MyObj->bOverrideBlendIn = bOverrideBlendIn;
 	MyObj->BlendInOverride = BlendInOverride;
+	MyObj->BlendInPreset = BlendInPreset;
 	MyObj->OverrideBlendOutTimeOnCancelAbility = OverrideBlendOutTimeOnCancelAbility;
 	MyObj->OverrideBlendOutTimeOnEndAbility = OverrideBlendOutTimeOnEndAbility;
 	
@@ -161,7 +163,7 @@ float UAbilityTask_PlayMontageAdvanced::PlayDrivenMontageForMesh(UPlayMontageAbi
 	
 	return ASC->PlayMontageForMesh(
 		Ability, Montage.Mesh, Ability->GetCurrentActivationInfo(), Montage.Montage, ScaledRate,
-		bOverrideBlendIn, BlendInOverride, StartSection, StartTimeSeconds, bReplicate);
+		bOverrideBlendIn, BlendInOverride, StartSection, StartTimeSeconds, bReplicate, BlendInPreset);
 }
 
 void UAbilityTask_PlayMontageAdvanced::Activate()
@@ -258,19 +260,26 @@ void UAbilityTask_PlayMontageAdvanced::Activate()
 			}
 			
 			// Play Driver Montage
-			const float Duration = ASC->PlayMontageForMesh(Ability, ActorInfo->SkeletalMeshComponent.Get(),
+			USkeletalMeshComponent* DriverMesh = ActorInfo->SkeletalMeshComponent.Get();
+			const float Duration = ASC->PlayMontageForMesh(Ability, DriverMesh,
 				Ability->GetCurrentActivationInfo(), MontageToPlay, Rate, bOverrideBlendIn, BlendInOverride,
-				StartSection, StartTimeSeconds, true);
+				StartSection, StartTimeSeconds, true, BlendInPreset);
 
 			// Play Driven Montages
 			if (Duration > 0.f)
 			{
+				// When replicated as a group, driven montages are derived from the driver's replicated entry
 				for (const auto& Montage : DrivenMontages.DrivenMontages)
 				{
-					constexpr bool bReplicate = true;
+					const bool bReplicate = !bReplicateDrivenMontagesAsGroup;
 					PlayDrivenMontageForMesh(ASC, Duration, Montage, bReplicate);
 				}
 
+				if (bReplicateDrivenMontagesAsGroup)
+				{
+					ASC->SetDrivenMontagesForMesh(DriverMesh, DrivenMontages.DrivenMontages, bDrivenMontagesMatchDriverDuration);
+				}
+
 				for (const auto& Montage : DrivenMontages.LocalDrivenMontages)
 				{
 					constexpr bool bReplicate = false;
@@ -403,26 +412,86 @@ bool UAbilityTask_PlayMontageAdvanced::StopPlayingMontage(float OverrideBlendOut
 				MontageInstance->OnMontageEnded.Unbind();
 			}
 
-			// Driver Montage
-			ASC->CurrentMontageStopForMesh(Mesh, OverrideBlendOutTime);
-			
-			// Driven Montages
-			for (const auto& Montage : DrivenMontages.DrivenMontages)
-			{
-				ASC->CurrentMontageStopForMesh(Montage.Mesh, OverrideBlendOutTime);
-			}
-
-			// Local Driven Montages
-			for (const auto& Montage : DrivenMontages.LocalDrivenMontages)
-			{
-				ASC->CurrentMontageStopForMesh(Montage.Mesh, OverrideBlendOutTime);
-			}
+			// Driver, Driven and Local Driven Montages
+			TArray<USkeletalMeshComponent*> Meshes;
+			GetMontageGroupMeshes(Meshes);
+			ASC->CurrentMontageStopForMeshes(Meshes, OverrideBlendOutTime);
 		}
 	}
 
 	return false;
 }
 
+UPlayMontageAbilitySystemComponent* UAbilityTask_PlayMontageAdvanced::GetMontageGroupMeshes(
+	TArray<USkeletalMeshComponent*>& OutMeshes) const
+{
+	OutMeshes.Reset();
+
+	const FGameplayAbilityActorInfo* ActorInfo = Ability ? Ability->GetCurrentActorInfo() : nullptr;
+	UPlayMontageAbilitySystemComponent* ASC = AbilitySystemComponent.IsValid() ?
+		Cast<UPlayMontageAbilitySystemComponent>(AbilitySystemComponent.Get()) : nullptr;
+	if (!ActorInfo || !ASC)
+	{
+		return nullptr;
+	}
+
+	if (USkeletalMeshComponent* DriverMesh = ActorInfo->SkeletalMeshComponent.Get())
+	{
+		OutMeshes.Add(DriverMesh);
+	}
+	for (const auto& Montage : DrivenMontages.DrivenMontages)
+	{
+		OutMeshes.Add(Montage.Mesh);
+	}
+	for (const auto& Montage : DrivenMontages.LocalDrivenMontages)
+	{
+		OutMeshes.Add(Montage.Mesh);
+	}
+	return ASC;
+}
+
+void UAbilityTask_PlayMontageAdvanced::JumpToSectionForMontageGroup(FName SectionName)
+{
+	TArray<USkeletalMeshComponent*> Meshes;
+	if (UPlayMontageAbilitySystemComponent* ASC = GetMontageGroupMeshes(Meshes))
+	{
+		ASC->CurrentMontageJumpToSectionForMeshes(Meshes, SectionName);
+	}
+}
+
+void UAbilityTask_PlayMontageAdvanced::SetPlayRateForMontageGroup(float InPlayRate)
+{
+	TArray<USkeletalMeshComponent*> Meshes;
+	UPlayMontageAbilitySystemComponent* ASC = GetMontageGroupMeshes(Meshes);
+	if (!ASC || Meshes.Num() == 0)
+	{
+		return;
+	}
+
+	// Meshes are ordered driver first, then driven and local driven montages
+	TArray<float> PlayRates = { InPlayRate };
+	const float DriverPlayLength = MontageToPlay ? MontageToPlay->GetPlayLength() : 0.f;
+	auto AddDrivenPlayRates = [&](const TArray<FDrivenMontagePair>& Montages)
+	{
+		for (const FDrivenMontagePair& Montage : Montages)
+		{
+			const float Scale = bDrivenMontagesMatchDriverDuration ?
+				UPlayMontageAdvancedLib::GetMontagePlayRateScaledByDuration(Montage.Montage, DriverPlayLength) : 1.f;
+			PlayRates.Add(InPlayRate * Scale);
+		}
+	};
+	AddDrivenPlayRates(DrivenMontages.DrivenMontages);
+	AddDrivenPlayRates(DrivenMontages.LocalDrivenMontages);
+
+	// No driver mesh, only driven montages
+	if (PlayRates.Num() > Meshes.Num())
+	{
+		PlayRates.RemoveAt(0);
+	}
+
+	ASC->CurrentMontageSetPlayRateForMeshes(Meshes, PlayRates);
+}
+
 void UAbilityTask_PlayMontageAdvanced::OnGameplayEvent(FGameplayTag EventTag, const FGameplayEventData* Payload)
 {
 	if (ShouldBroadcastAbilityTaskDelegates())
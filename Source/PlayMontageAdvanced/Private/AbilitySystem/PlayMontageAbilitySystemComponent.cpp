@@ -4,8 +4,21 @@
 #include "AbilitySystem/PlayMontageAbilitySystemComponent.h"
 
 #include "AbilitySystemLog.h"
+#include "PlayMontageAdvancedLib.h"
+#include "PlayMontageAdvancedMetrics.h"
+#include "PlayMontageAdvancedSectionCache.h"
+#include "PlayMontageAdvancedSettings.h"
+#include "PlayMontageAdvancedStats.h"
+#include "PlayMontageReplicationSubsystem.h"
 #include "AbilitySystem/PlayMontageGameplayAbility.h"
+#include "Algo/Compare.h"
+#include "Engine/DemoNetDriver.h"
+#include "Engine/NetConnection.h"
+#include "Engine/PackageMapClient.h"
+#include "GameFramework/GameStateBase.h"
 #include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
+#include "UObject/UObjectIterator.h"
 
 // Most of this is from GASShooter and therefore also Copyright 2024 Dan Kestranek.
 // https://github.com/tranek/GASShooter
@@ -18,39 +31,477 @@ static TAutoConsoleVariable<float> CVarReplayMontageErrorThreshold(
 	TEXT("Tolerance level for when montage playback position correction occurs in replays")
 );
 
+static TAutoConsoleVariable<float> CVarDeadReckoningMontageErrorThreshold(
+	TEXT("PlayMontageAdvanced.DeadReckoning.ErrorThreshold"),
+	0.05f,
+	TEXT("When using montage dead reckoning, the authority only resamples the montage timeline when it drifts from the extrapolated position by more than this")
+);
+
+static TAutoConsoleVariable<bool> CVarCoalesceMontageControls(
+	TEXT("PlayMontageAdvanced.CoalesceMontageControls"),
+	true,
+	TEXT("If true, owning clients buffer montage play rate changes and send the latest state once per frame through an unreliable RPC")
+);
+
+static TAutoConsoleVariable<int32> CVarMontageControlResends(
+	TEXT("PlayMontageAdvanced.MontageControlResends"),
+	2,
+	TEXT("Number of additional frames a coalesced montage control state is resent on, in case the unreliable RPC is dropped")
+);
+
+static TAutoConsoleVariable<float> CVarMontageJoinNotifyWindow(
+	TEXT("PlayMontageAdvanced.JoinInProgress.NotifyWindow"),
+	0.25f,
+	TEXT("When a simulated proxy joins a montage in progress it starts this many seconds before the replicated position, only notifies within this window are triggered")
+);
+
+static TAutoConsoleVariable<int32> CVarMontageJoinMaxPerFrame(
+	TEXT("PlayMontageAdvanced.JoinInProgress.MaxPerFrame"),
+	8,
+	TEXT("Maximum number of montages joined in progress per frame, the rest are deferred to later frames. 0 is unlimited")
+);
+
+static FAutoConsoleCommand MontageMeshEntriesDumpCommand(
+	TEXT("PlayMontageAdvanced.DumpMeshEntries"),
+	TEXT("Logs the number of per-mesh montage entries and the memory they use for every ability system component"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		int32 TotalEntries = 0;
+		SIZE_T TotalSize = 0;
+		for (TObjectIterator<UPlayMontageAbilitySystemComponent> It; It; ++It)
+		{
+			if (It->IsTemplate())
+			{
+				continue;
+			}
+
+			const int32 NumEntries = It->GetNumMeshEntries();
+			const SIZE_T AllocatedSize = It->GetMeshEntriesAllocatedSize();
+			ABILITY_LOG(Log, TEXT("%s: %d mesh entries, %llu bytes"), *GetPathNameSafe(*It), NumEntries, (uint64)AllocatedSize);
+			TotalEntries += NumEntries;
+			TotalSize += AllocatedSize;
+		}
+		ABILITY_LOG(Log, TEXT("Total: %d mesh entries, %llu bytes"), TotalEntries, (uint64)TotalSize);
+	})
+);
+
+namespace MontageJoinBudget
+{
+	struct FBudget
+	{
+		uint64 Frame = 0;
+		int32 NumJoins = 0;
+	};
+
+	/** Budgets are per world, PIE and listen servers tick several worlds in the same frame */
+	static TMap<TObjectKey<UWorld>, FBudget> Budgets;
+}
+
+/** @return True if another montage can be joined in progress in the world this frame */
+static bool ConsumeMontageJoinBudget(const UWorld* World)
+{
+	using namespace MontageJoinBudget;
+
+	if (!Budgets.Contains(World))
+	{
+		// Drop the budgets of worlds that were torn down
+		for (auto It = Budgets.CreateIterator(); It; ++It)
+		{
+			if (!It.Key().ResolveObjectPtr())
+			{
+				It.RemoveCurrent();
+			}
+		}
+	}
+
+	FBudget& Budget = Budgets.FindOrAdd(World);
+	if (Budget.Frame != GFrameCounter)
+	{
+		Budget.Frame = GFrameCounter;
+		Budget.NumJoins = 0;
+	}
+
+	const int32 MaxJoinsPerFrame = CVarMontageJoinMaxPerFrame.GetValueOnGameThread();
+	if (MaxJoinsPerFrame > 0 && Budget.NumJoins >= MaxJoinsPerFrame)
+	{
+		return false;
+	}
+	Budget.NumJoins++;
+	return true;
+}
+
+/** Batches the montage changes made in scope into a single net update */
+struct FScopedMontageBatch
+{
+	explicit FScopedMontageBatch(UPlayMontageAbilitySystemComponent* InASC)
+		: ASC(InASC)
+	{
+		ASC->BeginMontageBatch();
+	}
+
+	~FScopedMontageBatch()
+	{
+		ASC->EndMontageBatch();
+	}
+
+private:
+	UPlayMontageAbilitySystemComponent* ASC;
+};
+
 bool FPlayTagGameplayAbilityRepAnimMontage::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
 {
 	FGameplayAbilityRepAnimMontage::NetSerialize(Ar, Map, bOutSuccess);
 
-	Ar << bOverrideBlendIn;
-	Ar << BlendInOverride.Blend.BlendTime;
-	Ar << BlendInOverride.Blend.BlendOption;
-	Ar << BlendInOverride.Blend.CustomCurve;
-	Ar << BlendInOverride.BlendMode;
-	Ar << BlendInOverride.BlendProfile;
+	// The time the position was sampled at is only needed to extrapolate it
+	uint8 bRepDeadReckoning = bDeadReckoning ? 1 : 0;
+	Ar.SerializeBits(&bRepDeadReckoning, 1);
+	bDeadReckoning = bRepDeadReckoning != 0;
+	if (bDeadReckoning)
+	{
+		Ar << PositionServerTime;
+	}
+
+	uint8 bRepOverrideBlendIn = bOverrideBlendIn ? 1 : 0;
+	Ar.SerializeBits(&bRepOverrideBlendIn, 1);
+	bOverrideBlendIn = bRepOverrideBlendIn != 0;
+
+	// Nearly all montages use their own blend settings, only send the override block when it is used
+	if (!bOverrideBlendIn)
+	{
+		if (Ar.IsLoading())
+		{
+			BlendInOverride = FMontageBlendSettings();
+			BlendInPresetID = UPlayMontageAdvancedSettings::INVALID_BLEND_IN_PRESET_ID;
+		}
+		return true;
+	}
+
+	// Presets are resolved locally by the receiver, avoiding the object references entirely
+	uint8 bUsesPreset = BlendInPresetID != UPlayMontageAdvancedSettings::INVALID_BLEND_IN_PRESET_ID ? 1 : 0;
+	Ar.SerializeBits(&bUsesPreset, 1);
+	if (bUsesPreset)
+	{
+		Ar << BlendInPresetID;
+		return true;
+	}
+	
+	if (Ar.IsLoading())
+	{
+		BlendInPresetID = UPlayMontageAdvancedSettings::INVALID_BLEND_IN_PRESET_ID;
+	}
+
+	// Blend time is quantized to milliseconds
+	uint16 QuantizedBlendTime = 0;
+	if (Ar.IsSaving())
+	{
+		QuantizedBlendTime = (uint16)FMath::Clamp(FMath::RoundToInt(BlendInOverride.Blend.BlendTime * 1000.f), 0, (int32)MAX_uint16);
+	}
+	Ar << QuantizedBlendTime;
+	if (Ar.IsLoading())
+	{
+		BlendInOverride.Blend.BlendTime = QuantizedBlendTime / 1000.f;
+	}
+
+	uint32 BlendOption = (uint32)BlendInOverride.Blend.BlendOption;
+	Ar.SerializeInt(BlendOption, (uint32)EAlphaBlendOption::Custom + 1);
+	BlendInOverride.Blend.BlendOption = (EAlphaBlendOption)BlendOption;
+
+	uint8 bInertialization = BlendInOverride.BlendMode == EMontageBlendMode::Inertialization ? 1 : 0;
+	Ar.SerializeBits(&bInertialization, 1);
+	BlendInOverride.BlendMode = bInertialization ? EMontageBlendMode::Inertialization : EMontageBlendMode::Standard;
+
+	// The curve is only used by the custom blend option
+	if (BlendInOverride.Blend.BlendOption == EAlphaBlendOption::Custom)
+	{
+		Ar << BlendInOverride.Blend.CustomCurve;
+	}
+	else if (Ar.IsLoading())
+	{
+		BlendInOverride.Blend.CustomCurve = nullptr;
+	}
+
+	uint8 bHasBlendProfile = BlendInOverride.BlendProfile ? 1 : 0;
+	Ar.SerializeBits(&bHasBlendProfile, 1);
+	if (bHasBlendProfile)
+	{
+		Ar << BlendInOverride.BlendProfile;
+	}
+	else if (Ar.IsLoading())
+	{
+		BlendInOverride.BlendProfile = nullptr;
+	}
 	
 	return true;
 }
 
+bool FPlayTagGameplayAbilityRepAnimMontage::HasReplicatedChanges(const FPlayTagGameplayAbilityRepAnimMontage& Other) const
+{
+	return HasReplicatedEventChanges(Other)
+		|| Position != Other.Position
+		|| BlendTime != Other.BlendTime
+		|| PositionServerTime != Other.PositionServerTime;
+}
+
+bool FPlayTagGameplayAbilityRepAnimMontage::HasReplicatedEventChanges(const FPlayTagGameplayAbilityRepAnimMontage& Other) const
+{
+	return Animation != Other.Animation
+		|| PlayRate != Other.PlayRate
+		|| NextSectionID != Other.NextSectionID
+		|| IsStopped != Other.IsStopped
+		|| SkipPositionCorrection != Other.SkipPositionCorrection
+		|| bSkipPlayRate != Other.bSkipPlayRate
+		|| bOverrideBlendIn != Other.bOverrideBlendIn
+		|| BlendInPresetID != Other.BlendInPresetID
+		|| bDeadReckoning != Other.bDeadReckoning;
+}
+
+bool FGameplayAbilityRepAnimMontageForMesh::IsUnchangedSinceLastApplied() const
+{
+	return bHasAppliedRepMontageInfo
+		&& !RepMontageInfo.HasReplicatedChanges(LastAppliedRepMontageInfo)
+		&& bDrivenMontagesMatchDriverDuration == bLastAppliedDrivenMontagesMatchDriverDuration
+		&& Algo::Compare(LastAppliedDrivenMontages, DrivenMontages, [](const FDrivenMontagePair& A, const FDrivenMontagePair& B)
+		{
+			return A.Mesh == B.Mesh && A.Montage == B.Montage;
+		});
+}
+
+void FGameplayAbilityRepAnimMontageForMesh::SetLastApplied(const FPlayTagGameplayAbilityRepAnimMontage& AppliedRepMontageInfo)
+{
+	LastAppliedRepMontageInfo = AppliedRepMontageInfo;
+	LastAppliedDrivenMontages = DrivenMontages;
+	bLastAppliedDrivenMontagesMatchDriverDuration = bDrivenMontagesMatchDriverDuration;
+	bHasAppliedRepMontageInfo = true;
+}
+
+void FGameplayAbilityRepAnimMontageForMesh::PreReplicatedRemove(const FGameplayAbilityRepAnimMontageContainer& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->OnRep_RemovedAnimMontageEntry(*this);
+	}
+}
+
+void FGameplayAbilityRepAnimMontageForMesh::PostReplicatedAdd(const FGameplayAbilityRepAnimMontageContainer& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->OnRep_ReplicatedAnimMontageEntry(*this);
+	}
+}
+
+void FGameplayAbilityRepAnimMontageForMesh::PostReplicatedChange(const FGameplayAbilityRepAnimMontageContainer& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->OnRep_ReplicatedAnimMontageEntry(*this);
+	}
+}
+
+FGameplayAbilityRepAnimMontageForMesh* FGameplayAbilityRepAnimMontageContainer::FindItemForMesh(const USkeletalMeshComponent* InMesh)
+{
+	if (const int32* CachedIndex = ItemIndices.Find(InMesh))
+	{
+		if (Items.IsValidIndex(*CachedIndex) && Items[*CachedIndex].Mesh == InMesh)
+		{
+			return &Items[*CachedIndex];
+		}
+	}
+
+	// Replication reordered or removed items since the index was cached
+	const int32 ItemIndex = Items.IndexOfByPredicate([InMesh](const FGameplayAbilityRepAnimMontageForMesh& Item)
+	{
+		return Item.Mesh == InMesh;
+	});
+	if (ItemIndex == INDEX_NONE)
+	{
+		ItemIndices.Remove(InMesh);
+		return nullptr;
+	}
+
+	ItemIndices.Add(InMesh, ItemIndex);
+	return &Items[ItemIndex];
+}
+
+FGameplayAbilityRepAnimMontageForMesh& FGameplayAbilityRepAnimMontageContainer::AddItemForMesh(USkeletalMeshComponent* InMesh)
+{
+	ItemIndices.Add(InMesh, Items.Num());
+	FGameplayAbilityRepAnimMontageForMesh& Item = Items.Add_GetRef(FGameplayAbilityRepAnimMontageForMesh(InMesh));
+	MarkEntryDirty(Item);
+	return Item;
+}
+
+int32 FGameplayAbilityRepAnimMontageContainer::RemoveStaleItems()
+{
+	const int32 NumRemoved = Items.RemoveAllSwap([](const FGameplayAbilityRepAnimMontageForMesh& Item)
+	{
+		return UPlayMontageAbilitySystemComponent::IsStaleMesh(Item.Mesh);
+	});
+	if (NumRemoved > 0)
+	{
+		// Indices are revalidated on use, only the stale keys need to go
+		ItemIndices.Reset();
+		EventRevision++;
+		MarkArrayDirty();
+		if (Owner)
+		{
+			MARK_PROPERTY_DIRTY_FROM_NAME(UPlayMontageAbilitySystemComponent, RepAnimMontageInfoForMeshes, Owner);
+		}
+	}
+	return NumRemoved;
+}
+
+void FGameplayAbilityRepAnimMontageContainer::MarkEntryDirty(FGameplayAbilityRepAnimMontageForMesh& Entry, bool bPositionRefreshOnly)
+{
+	if (!bPositionRefreshOnly)
+	{
+		EventRevision++;
+	}
+	MarkItemDirty(Entry);
+
+	// Push model, the container is only compared once an entry is marked dirty
+	if (Owner)
+	{
+		MARK_PROPERTY_DIRTY_FROM_NAME(UPlayMontageAbilitySystemComponent, RepAnimMontageInfoForMeshes, Owner);
+	}
+}
+
+bool FGameplayAbilityRepAnimMontageContainer::NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+{
+	// Only sends to a connection that already has a base state are subject to LOD
+	const FNetFastTArrayBaseState* OldState = static_cast<FNetFastTArrayBaseState*>(DeltaParms.OldState);
+	const UPackageMapClient* PackageMap = Cast<UPackageMapClient>(DeltaParms.Map);
+	UNetConnection* Connection = DeltaParms.Writer && OldState && Owner && PackageMap ? PackageMap->GetConnection() : nullptr;
+	if (!Connection)
+	{
+		const int64 StartBits = DeltaParms.Writer ? DeltaParms.Writer->GetNumBits() : 0;
+		const bool bResult = FastArrayDeltaSerialize<FGameplayAbilityRepAnimMontageForMesh, FGameplayAbilityRepAnimMontageContainer>(Items, DeltaParms, *this);
+		if (bResult && DeltaParms.Writer)
+		{
+			FPlayMontageAdvancedMetrics& Metrics = FPlayMontageAdvancedMetrics::Get();
+			Metrics.ReplicatedBytes += (DeltaParms.Writer->GetNumBits() - StartBits + 7) >> 3;
+			Metrics.ReplicatedUpdates++;
+		}
+		return bResult;
+	}
+
+	FMontageRepConnectionLOD* ConnectionLOD = ConnectionLODs.Find(Connection);
+	if (!ConnectionLOD)
+	{
+		// Drop connections that have since closed
+		for (auto It = ConnectionLODs.CreateIterator(); It; ++It)
+		{
+			if (!It.Key().IsValid())
+			{
+				It.RemoveCurrent();
+			}
+		}
+		ConnectionLOD = &ConnectionLODs.Add(Connection);
+		ConnectionLOD->LastSentEventRevision = EventRevision - 1;
+	}
+
+	const double WorldTime = Owner->GetWorld() ? Owner->GetWorld()->GetTimeSeconds() : 0.0;
+	const bool bPositionRefreshOnly = ConnectionLOD->LastSentEventRevision == EventRevision;
+	const FMontageReplicationLODTier* LODTier = Owner->GetMontageReplicationLODTier(Connection);
+	if (LODTier && bPositionRefreshOnly && OldState->ArrayReplicationKey != ArrayReplicationKey)
+	{
+		const bool bRefreshDue = LODTier->PositionRefreshInterval >= 0.f && WorldTime - ConnectionLOD->LastSentTime >= LODTier->PositionRefreshInterval;
+		if (!bRefreshDue)
+		{
+			// Keep the old base state, the latest position goes out with the next event or refresh
+			INC_DWORD_STAT(STAT_MontageRepLOD_SkippedRefreshes);
+			INC_DWORD_STAT_BY(STAT_MontageRepLOD_BytesSaved, (uint32)((LastPositionRefreshBits + 7) >> 3));
+			return false;
+		}
+	}
+
+	const int64 StartBits = DeltaParms.Writer->GetNumBits();
+	if (!FastArrayDeltaSerialize<FGameplayAbilityRepAnimMontageForMesh, FGameplayAbilityRepAnimMontageContainer>(Items, DeltaParms, *this))
+	{
+		return false;
+	}
+
+	if (LODTier)
+	{
+		INC_DWORD_STAT(STAT_MontageRepLOD_ReducedRateSends);
+	}
+	else
+	{
+		INC_DWORD_STAT(STAT_MontageRepLOD_FullRateSends);
+	}
+
+	const int64 SentBits = DeltaParms.Writer->GetNumBits() - StartBits;
+	if (bPositionRefreshOnly)
+	{
+		LastPositionRefreshBits = SentBits;
+	}
+
+	FPlayMontageAdvancedMetrics& Metrics = FPlayMontageAdvancedMetrics::Get();
+	Metrics.ReplicatedBytes += (SentBits + 7) >> 3;
+	Metrics.ReplicatedUpdates++;
+
+	ConnectionLOD->LastSentEventRevision = EventRevision;
+	ConnectionLOD->LastSentTime = WorldTime;
+	return true;
+}
+
+UPlayMontageAbilitySystemComponent::UPlayMontageAbilitySystemComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	RepAnimMontageInfoForMeshes.Owner = this;
+}
+
 void UPlayMontageAbilitySystemComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 	
-	DOREPLIFETIME(ThisClass, RepAnimMontageInfoForMeshes);
+	// Replays record the montage event log instead, if enabled
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+	Params.Condition = bRecordMontageReplayEvents ? COND_SkipReplay : COND_None;
+	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, RepAnimMontageInfoForMeshes, Params);
+
+	Params.Condition = COND_ReplayOnly;
+	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, MontageReplayEvents, Params);
 }
 
-bool UPlayMontageAbilitySystemComponent::GetShouldTick() const
+void UPlayMontageAbilitySystemComponent::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)
 {
-	for (const FGameplayAbilityRepAnimMontageForMesh& RepMontageInfo : RepAnimMontageInfoForMeshes)
+	UPlayMontageAbilitySystemComponent* This = CastChecked<UPlayMontageAbilitySystemComponent>(InThis);
+	for (const TUniquePtr<FGameplayAbilityLocalAnimMontageForMesh>& AnimMontageInfo : This->LocalAnimMontageInfoForMeshes)
 	{
-		const bool bHasReplicatedMontageInfoToUpdate = (IsOwnerActorAuthoritative() && RepMontageInfo.RepMontageInfo.IsStopped == false);
+		Collector.AddReferencedObject(AnimMontageInfo->LocalMontageInfo.AnimMontage, This);
+		for (FDrivenMontagePair& DrivenMontage : AnimMontageInfo->SimulatedDrivenMontages)
+		{
+			Collector.AddReferencedObject(DrivenMontage.Montage, This);
+			Collector.AddReferencedObject(DrivenMontage.Mesh, This);
+		}
+	}
+
+	Super::AddReferencedObjects(InThis, Collector);
+}
 
-		if (bHasReplicatedMontageInfoToUpdate)
+bool UPlayMontageAbilitySystemComponent::GetShouldTick() const
+{
+	// The montage replication subsystem updates the replicated montages when batching
+	if (!GetMontageReplicationSubsystem())
+	{
+		for (const FGameplayAbilityRepAnimMontageForMesh& RepMontageInfo : RepAnimMontageInfoForMeshes.Items)
 		{
-			return true;
+			const bool bHasReplicatedMontageInfoToUpdate = (IsOwnerActorAuthoritative() && RepMontageInfo.RepMontageInfo.IsStopped == false);
+
+			if (bHasReplicatedMontageInfoToUpdate)
+			{
+				return true;
+			}
 		}
 	}
 
+	if (PendingMontageControls.Num() > 0 || PendingMontageJoinMeshes.Num() > 0 || MontagePositionWarps.Num() > 0)
+	{
+		return true;
+	}
+
 	return Super::GetShouldTick();
 }
 
@@ -59,30 +510,152 @@ void UPlayMontageAbilitySystemComponent::TickComponent(float DeltaTime, ELevelTi
 {
 	if (IsOwnerActorAuthoritative())
 	{
-		for (FGameplayAbilityLocalAnimMontageForMesh& MontageInfo : LocalAnimMontageInfoForMeshes)
+		// Nothing references the replicated items between ticks, drop the entries of meshes that were swapped out
+		PruneStaleRepAnimMontageItems();
+
+		// Only meshes that were played with replication have an entry to update
+		if (!GetMontageReplicationSubsystem())
 		{
-			AnimMontage_UpdateReplicatedDataForMesh(MontageInfo.Mesh);
+			for (FGameplayAbilityRepAnimMontageForMesh& RepMontageInfo : RepAnimMontageInfoForMeshes.Items)
+			{
+				AnimMontage_UpdateReplicatedDataForMesh(RepMontageInfo);
+			}
 		}
 	}
+	else
+	{
+		FlushPendingMontageControls();
+		ProcessPendingMontageJoins();
+		UpdateMontagePositionWarps(DeltaTime);
+	}
 	
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 }
 
+void UPlayMontageAbilitySystemComponent::InitAbilityActorInfo(AActor* InOwnerActor, AActor* InAvatarActor)
+{
+	Super::InitAbilityActorInfo(InOwnerActor, InAvatarActor);
+
+	PruneStaleMeshEntries();
+	RegisterLocalAnimMontageSlotsForAvatar();
+}
+
+void UPlayMontageAbilitySystemComponent::OnUnregister()
+{
+	if (UPlayMontageReplicationSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<UPlayMontageReplicationSubsystem>() : nullptr)
+	{
+		Subsystem->UnregisterComponent(this);
+	}
+
+	Super::OnUnregister();
+}
+
+UPlayMontageReplicationSubsystem* UPlayMontageAbilitySystemComponent::GetMontageReplicationSubsystem() const
+{
+	const UWorld* World = GetWorld();
+	return World && IsOwnerActorAuthoritative() ? World->GetSubsystem<UPlayMontageReplicationSubsystem>() : nullptr;
+}
+
+void UPlayMontageAbilitySystemComponent::UpdateMontageReplicationBatchRegistration()
+{
+	UPlayMontageReplicationSubsystem* Subsystem = MontageReplicationBatchIndex == INDEX_NONE ? GetMontageReplicationSubsystem() : nullptr;
+	if (!Subsystem)
+	{
+		return;
+	}
+
+	// The subsystem drops the component once nothing is playing, see UpdateReplicatedMontagesForBatch
+	const bool bHasPlayingMontage = RepAnimMontageInfoForMeshes.Items.ContainsByPredicate([](const FGameplayAbilityRepAnimMontageForMesh& RepMontageInfo)
+	{
+		return !RepMontageInfo.RepMontageInfo.IsStopped;
+	});
+	if (bHasPlayingMontage)
+	{
+		Subsystem->RegisterComponent(this);
+	}
+}
+
+bool UPlayMontageAbilitySystemComponent::UpdateReplicatedMontagesForBatch()
+{
+	if (!IsOwnerActorAuthoritative())
+	{
+		return false;
+	}
+
+	PruneStaleRepAnimMontageItems();
+
+	bool bHasPlayingMontage = false;
+	for (FGameplayAbilityRepAnimMontageForMesh& RepMontageInfo : RepAnimMontageInfoForMeshes.Items)
+	{
+		AnimMontage_UpdateReplicatedDataForMesh(RepMontageInfo);
+		bHasPlayingMontage |= !RepMontageInfo.RepMontageInfo.IsStopped;
+	}
+	return bHasPlayingMontage;
+}
+
+void UPlayMontageAbilitySystemComponent::GatherReplicatedMontagesForBatch()
+{
+	const TArray<FGameplayAbilityRepAnimMontageForMesh>& Items = RepAnimMontageInfoForMeshes.Items;
+	MontageReplicationStaging.Reset();
+	MontageReplicationStaging.SetNum(Items.Num());
+	MontageReplicationStagingValid.Init(false, Items.Num());
+	if (!IsOwnerActorAuthoritative())
+	{
+		return;
+	}
+
+	for (int32 ItemIndex = 0; ItemIndex < Items.Num(); ItemIndex++)
+	{
+		MontageReplicationStagingValid[ItemIndex] = GatherReplicatedDataForMesh(Items[ItemIndex], MontageReplicationStaging[ItemIndex]);
+	}
+}
+
+bool UPlayMontageAbilitySystemComponent::CommitReplicatedMontagesForBatch()
+{
+	TArray<FGameplayAbilityRepAnimMontageForMesh>& Items = RepAnimMontageInfoForMeshes.Items;
+	if (!IsOwnerActorAuthoritative() || MontageReplicationStaging.Num() != Items.Num())
+	{
+		return UpdateReplicatedMontagesForBatch();
+	}
+
+	bool bHasPlayingMontage = false;
+	for (int32 ItemIndex = 0; ItemIndex < Items.Num(); ItemIndex++)
+	{
+		if (MontageReplicationStagingValid[ItemIndex])
+		{
+			CommitReplicatedDataForMesh(Items[ItemIndex], MontageReplicationStaging[ItemIndex]);
+		}
+		bHasPlayingMontage |= !Items[ItemIndex].RepMontageInfo.IsStopped;
+	}
+
+	// After the commit, the staging buffer is indexed by item
+	PruneStaleRepAnimMontageItems();
+	return bHasPlayingMontage;
+}
+
 float UPlayMontageAbilitySystemComponent::PlayMontageForMesh(UGameplayAbility* AnimatingAbility,
 	USkeletalMeshComponent* InMesh, FGameplayAbilityActivationInfo ActivationInfo, UAnimMontage* Montage,
 	float InPlayRate, bool bOverrideBlendIn, const FMontageBlendSettings& BlendInOverride, FName StartSectionName,
-	float StartTimeSeconds, bool bReplicateMontage)
+	float StartTimeSeconds, bool bReplicateMontage, FName BlendInPreset)
 {
 	UPlayMontageGameplayAbility* InAbility = Cast<UPlayMontageGameplayAbility>(AnimatingAbility);
 
 	float Duration = -1.f;
 
+	// Use the preset if one was requested, only its ID gets replicated
+	const UPlayMontageAdvancedSettings* Settings = GetDefault<UPlayMontageAdvancedSettings>();
+	const uint8 BlendInPresetID = Settings->GetBlendInPresetID(BlendInPreset);
+	const FMontageBlendSettings* BlendInPresetSettings = Settings->GetBlendInPreset(BlendInPresetID);
+	const FMontageBlendSettings& BlendInSettings = BlendInPresetSettings ? *BlendInPresetSettings : BlendInOverride;
+	bOverrideBlendIn |= BlendInPresetSettings != nullptr;
+
 	UAnimInstance* AnimInstance = IsValid(InMesh) && InMesh->GetOwner() == AbilityActorInfo->AvatarActor ? InMesh->GetAnimInstance() : nullptr;
 	if (AnimInstance && Montage)
 	{
 		Duration = bOverrideBlendIn ?
-			AnimInstance->Montage_PlayWithBlendSettings(Montage, BlendInOverride, InPlayRate, EMontagePlayReturnType::MontageLength, StartTimeSeconds) :
+			AnimInstance->Montage_PlayWithBlendSettings(Montage, BlendInSettings, InPlayRate, EMontagePlayReturnType::MontageLength, StartTimeSeconds) :
 			AnimInstance->Montage_Play(Montage, InPlayRate, EMontagePlayReturnType::MontageLength, StartTimeSeconds);
+		InvalidateMontageStateSnapshotForMesh(InMesh);
 		
 		if (Duration > 0.f)
 		{
@@ -106,6 +679,9 @@ float UPlayMontageAbilitySystemComponent::PlayMontageForMesh(UGameplayAbility* A
 
 			AnimMontageInfo.LocalMontageInfo.AnimMontage = Montage;
 			AnimMontageInfo.LocalMontageInfo.AnimatingAbility = AnimatingAbility;
+
+			// Build the section cache here, batched replication only reads it from worker threads
+			FMontageSectionCache::Get(Montage);
 			
 			if (InAbility)
 			{
@@ -116,6 +692,7 @@ float UPlayMontageAbilitySystemComponent::PlayMontageForMesh(UGameplayAbility* A
 			if (StartSectionName != NAME_None)
 			{
 				AnimInstance->Montage_JumpToSection(StartSectionName, Montage);
+				InvalidateMontageStateSnapshotForMesh(InMesh);
 			}
 
 			// Replicate to non owners
@@ -127,16 +704,19 @@ float UPlayMontageAbilitySystemComponent::PlayMontageForMesh(UGameplayAbility* A
 					FGameplayAbilityRepAnimMontageForMesh& AbilityRepMontageInfo = GetGameplayAbilityRepAnimMontageForMesh(InMesh);
 					AbilityRepMontageInfo.RepMontageInfo.Animation = Montage;
 					AbilityRepMontageInfo.RepMontageInfo.bOverrideBlendIn = bOverrideBlendIn;
-					AbilityRepMontageInfo.RepMontageInfo.BlendInOverride = BlendInOverride;
+					AbilityRepMontageInfo.RepMontageInfo.BlendInOverride = BlendInPresetSettings ? FMontageBlendSettings() : BlendInOverride;
+					AbilityRepMontageInfo.RepMontageInfo.BlendInPresetID = BlendInPresetID;
+					AbilityRepMontageInfo.DrivenMontages.Reset();
+
+					// Starting a montage is always a discontinuity
+					AbilityRepMontageInfo.RepMontageInfo.bDeadReckoning = false;
+					RepAnimMontageInfoForMeshes.MarkEntryDirty(AbilityRepMontageInfo);
 
 					// Update parameters that change during Montage life-time.
 					AnimMontage_UpdateReplicatedDataForMesh(InMesh);
 
 					// Force net update on our avatar actor
-					if (AbilityActorInfo->AvatarActor != nullptr)
-					{
-						AbilityActorInfo->AvatarActor->ForceNetUpdate();
-					}
+					ForceMontageNetUpdate();
 				}
 			}
 			else
@@ -156,20 +736,28 @@ float UPlayMontageAbilitySystemComponent::PlayMontageForMesh(UGameplayAbility* A
 
 float UPlayMontageAbilitySystemComponent::PlayMontageSimulatedForMesh(USkeletalMeshComponent* InMesh, UAnimMontage* Montage,
 	float InPlayRate, bool bOverrideBlendIn, const FMontageBlendSettings& BlendInOverride, float StartTimeSeconds, FName
-	StartSectionName)
+	StartSectionName, uint8 BlendInPresetID)
 {
 	float Duration = -1.f;
+
+	// Resolve the preset locally
+	const FMontageBlendSettings* BlendInPresetSettings = GetDefault<UPlayMontageAdvancedSettings>()->GetBlendInPreset(BlendInPresetID);
+	const FMontageBlendSettings& BlendInSettings = BlendInPresetSettings ? *BlendInPresetSettings : BlendInOverride;
+	bOverrideBlendIn |= BlendInPresetSettings != nullptr;
+
 	UAnimInstance* AnimInstance = IsValid(InMesh) && InMesh->GetOwner() == AbilityActorInfo->AvatarActor ? InMesh->GetAnimInstance() : nullptr;
 	if (AnimInstance && Montage)
 	{
 		Duration = bOverrideBlendIn ?
-			AnimInstance->Montage_PlayWithBlendSettings(Montage, BlendInOverride, InPlayRate, EMontagePlayReturnType::MontageLength, StartTimeSeconds) :
+			AnimInstance->Montage_PlayWithBlendSettings(Montage, BlendInSettings, InPlayRate, EMontagePlayReturnType::MontageLength, StartTimeSeconds) :
 			AnimInstance->Montage_Play(Montage, InPlayRate, EMontagePlayReturnType::MontageLength, StartTimeSeconds);
+		InvalidateMontageStateSnapshotForMesh(InMesh);
 		
 		if (Duration > 0.f)
 		{
 			FGameplayAbilityLocalAnimMontageForMesh& AnimMontageInfo = GetLocalAnimMontageInfoForMesh(InMesh);
 			AnimMontageInfo.LocalMontageInfo.AnimMontage = Montage;
+			FMontageSectionCache::Get(Montage);
 		}
 	}
 
@@ -180,8 +768,7 @@ void UPlayMontageAbilitySystemComponent::CurrentMontageStopForMesh(USkeletalMesh
 	float OverrideBlendOutTime)
 {
 	UAnimInstance* AnimInstance = IsValid(InMesh) && InMesh->GetOwner() == AbilityActorInfo->AvatarActor ? InMesh->GetAnimInstance() : nullptr;
-	FGameplayAbilityLocalAnimMontageForMesh& AnimMontageInfo = GetLocalAnimMontageInfoForMesh(InMesh);
-	UAnimMontage* MontageToStop = AnimMontageInfo.LocalMontageInfo.AnimMontage;
+	UAnimMontage* MontageToStop = FindLocalMontageForMesh(InMesh);
 	bool bShouldStopMontage = AnimInstance && MontageToStop && !AnimInstance->Montage_GetIsStopped(MontageToStop);
 
 	if (bShouldStopMontage)
@@ -189,6 +776,7 @@ void UPlayMontageAbilitySystemComponent::CurrentMontageStopForMesh(USkeletalMesh
 		const float BlendOutTime = (OverrideBlendOutTime >= 0.0f ? OverrideBlendOutTime : MontageToStop->BlendOut.GetBlendTime());
 
 		AnimInstance->Montage_Stop(BlendOutTime, MontageToStop);
+		InvalidateMontageStateSnapshotForMesh(InMesh);
 
 		if (IsOwnerActorAuthoritative())
 		{
@@ -199,50 +787,85 @@ void UPlayMontageAbilitySystemComponent::CurrentMontageStopForMesh(USkeletalMesh
 
 void UPlayMontageAbilitySystemComponent::StopAllCurrentMontages(float OverrideBlendOutTime)
 {
-	for (FGameplayAbilityLocalAnimMontageForMesh& GameplayAbilityLocalAnimMontageForMesh : LocalAnimMontageInfoForMeshes)
+	FScopedMontageBatch MontageBatch(this);
+	for (const TUniquePtr<FGameplayAbilityLocalAnimMontageForMesh>& GameplayAbilityLocalAnimMontageForMesh : LocalAnimMontageInfoForMeshes)
 	{
-		CurrentMontageStopForMesh(GameplayAbilityLocalAnimMontageForMesh.Mesh, OverrideBlendOutTime);
+		if (GameplayAbilityLocalAnimMontageForMesh->IsTombstone())
+		{
+			continue;
+		}
+		CurrentMontageStopForMesh(GameplayAbilityLocalAnimMontageForMesh->Mesh.Get(), OverrideBlendOutTime);
 	}
 }
 
 void UPlayMontageAbilitySystemComponent::StopMontageIfCurrentForMesh(USkeletalMeshComponent* InMesh,
 	const UAnimMontage& Montage, float OverrideBlendOutTime)
 {
-	FGameplayAbilityLocalAnimMontageForMesh& AnimMontageInfo = GetLocalAnimMontageInfoForMesh(InMesh);
-	if (&Montage == AnimMontageInfo.LocalMontageInfo.AnimMontage)
+	UAnimMontage* CurrentAnimMontage = FindLocalMontageForMesh(InMesh);
+	if (&Montage == CurrentAnimMontage)
 	{
 		CurrentMontageStopForMesh(InMesh, OverrideBlendOutTime);
 	}
 }
 
-void UPlayMontageAbilitySystemComponent::ClearAnimatingAbilityForAllMeshes(UGameplayAbility* Ability)
+void UPlayMontageAbilitySystemComponent::SetDrivenMontagesForMesh(USkeletalMeshComponent* DriverMesh,
+	const TArray<FDrivenMontagePair>& DrivenMontages, bool bMatchDriverDuration)
 {
-	UPlayMontageGameplayAbility* TagAbility = Cast<UPlayMontageGameplayAbility>(Ability);
-	for (FGameplayAbilityLocalAnimMontageForMesh& GameplayAbilityLocalAnimMontageForMesh : LocalAnimMontageInfoForMeshes)
+	if (!IsOwnerActorAuthoritative())
 	{
-		if (GameplayAbilityLocalAnimMontageForMesh.LocalMontageInfo.AnimatingAbility == Ability)
+		return;
+	}
+
+	if (FGameplayAbilityRepAnimMontageForMesh* DriverRepMontageInfo = FindGameplayAbilityRepAnimMontageForMesh(DriverMesh))
+	{
+		DriverRepMontageInfo->DrivenMontages = DrivenMontages;
+		DriverRepMontageInfo->bDrivenMontagesMatchDriverDuration = bMatchDriverDuration;
+		RepAnimMontageInfoForMeshes.MarkEntryDirty(*DriverRepMontageInfo);
+	}
+}
+
+void UPlayMontageAbilitySystemComponent::ClearAnimatingAbilityForAllMeshes(UGameplayAbility* Ability)
+{
+	bool bWasAnimating = false;
+	for (const TUniquePtr<FGameplayAbilityLocalAnimMontageForMesh>& GameplayAbilityLocalAnimMontageForMesh : LocalAnimMontageInfoForMeshes)
+	{
+		if (GameplayAbilityLocalAnimMontageForMesh->LocalMontageInfo.AnimatingAbility == Ability)
 		{
-			TagAbility->SetCurrentMontageForMesh(GameplayAbilityLocalAnimMontageForMesh.Mesh, nullptr);
-			GameplayAbilityLocalAnimMontageForMesh.LocalMontageInfo.AnimatingAbility = nullptr;
+			GameplayAbilityLocalAnimMontageForMesh->LocalMontageInfo.AnimatingAbility = nullptr;
+			bWasAnimating = true;
 		}
 	}
+
+	// The ability no longer animates any mesh, clear all of its montages at once
+	UPlayMontageGameplayAbility* TagAbility = Cast<UPlayMontageGameplayAbility>(Ability);
+	if (bWasAnimating && TagAbility)
+	{
+		TagAbility->ClearCurrentMontagesForAllMeshes();
+	}
 }
 
 void UPlayMontageAbilitySystemComponent::CurrentMontageJumpToSectionForMesh(USkeletalMeshComponent* InMesh,
 	FName SectionName)
 {
 	UAnimInstance* AnimInstance = IsValid(InMesh) && InMesh->GetOwner() == AbilityActorInfo->AvatarActor ? InMesh->GetAnimInstance() : nullptr;
-	FGameplayAbilityLocalAnimMontageForMesh& AnimMontageInfo = GetLocalAnimMontageInfoForMesh(InMesh);
-	if ((SectionName != NAME_None) && AnimInstance && AnimMontageInfo.LocalMontageInfo.AnimMontage)
+	UAnimMontage* CurrentAnimMontage = FindLocalMontageForMesh(InMesh);
+	if ((SectionName != NAME_None) && AnimInstance && CurrentAnimMontage)
 	{
-		AnimInstance->Montage_JumpToSection(SectionName, AnimMontageInfo.LocalMontageInfo.AnimMontage);
 		if (IsOwnerActorAuthoritative())
 		{
+			AnimInstance->Montage_JumpToSection(SectionName, CurrentAnimMontage);
+			InvalidateMontageStateSnapshotForMesh(InMesh);
 			AnimMontage_UpdateReplicatedDataForMesh(InMesh);
 		}
 		else
 		{
-			ServerCurrentMontageJumpToSectionNameForMesh(InMesh, AnimMontageInfo.LocalMontageInfo.AnimMontage, SectionName);
+			// Predict the jump, the section we jumped from is restored if the server rejects it
+			FScopedPredictionWindow ScopedPrediction(this, true);
+			PredictMontageSectionChangeForMesh(InMesh, CurrentAnimMontage, AnimInstance);
+			AnimInstance->Montage_JumpToSection(SectionName, CurrentAnimMontage);
+			InvalidateMontageStateSnapshotForMesh(InMesh);
+			ServerCurrentMontageJumpToSectionNameForMesh(InMesh, CurrentAnimMontage, SectionName, ScopedPredictionKey);
+			FPlayMontageAdvancedMetrics::Get().RPCs++;
 		}
 	}
 }
@@ -251,21 +874,25 @@ void UPlayMontageAbilitySystemComponent::CurrentMontageSetNextSectionNameForMesh
 	FName FromSectionName, FName ToSectionName)
 {
 	UAnimInstance* AnimInstance = IsValid(InMesh) && InMesh->GetOwner() == AbilityActorInfo->AvatarActor ? InMesh->GetAnimInstance() : nullptr;
-	FGameplayAbilityLocalAnimMontageForMesh& AnimMontageInfo = GetLocalAnimMontageInfoForMesh(InMesh);
-	if (AnimMontageInfo.LocalMontageInfo.AnimMontage && AnimInstance)
+	UAnimMontage* CurrentAnimMontage = FindLocalMontageForMesh(InMesh);
+	if (CurrentAnimMontage && AnimInstance)
 	{
-		// Set Next Section Name. 
-		AnimInstance->Montage_SetNextSection(FromSectionName, ToSectionName, AnimMontageInfo.LocalMontageInfo.AnimMontage);
-
 		// Update replicated version for Simulated Proxies if we are on the server.
 		if (IsOwnerActorAuthoritative())
 		{
+			AnimInstance->Montage_SetNextSection(FromSectionName, ToSectionName, CurrentAnimMontage);
 			AnimMontage_UpdateReplicatedDataForMesh(InMesh);
 		}
 		else
 		{
-			float CurrentPosition = AnimInstance->Montage_GetPosition(AnimMontageInfo.LocalMontageInfo.AnimMontage);
-			ServerCurrentMontageSetNextSectionNameForMesh(InMesh, AnimMontageInfo.LocalMontageInfo.AnimMontage, CurrentPosition, FromSectionName, ToSectionName);
+			// Predict the next section, the prior section links are restored if the server rejects it
+			FScopedPredictionWindow ScopedPrediction(this, true);
+			PredictMontageSectionChangeForMesh(InMesh, CurrentAnimMontage, AnimInstance);
+			AnimInstance->Montage_SetNextSection(FromSectionName, ToSectionName, CurrentAnimMontage);
+
+			const float CurrentPosition = AnimInstance->Montage_GetPosition(CurrentAnimMontage);
+			ServerCurrentMontageSetNextSectionNameForMesh(InMesh, CurrentAnimMontage, CurrentPosition, FromSectionName, ToSectionName, ScopedPredictionKey);
+			FPlayMontageAdvancedMetrics::Get().RPCs++;
 		}
 	}
 }
@@ -273,115 +900,247 @@ void UPlayMontageAbilitySystemComponent::CurrentMontageSetNextSectionNameForMesh
 void UPlayMontageAbilitySystemComponent::CurrentMontageSetPlayRateForMesh(USkeletalMeshComponent* InMesh, float InPlayRate)
 {
 	UAnimInstance* AnimInstance = IsValid(InMesh) && InMesh->GetOwner() == AbilityActorInfo->AvatarActor ? InMesh->GetAnimInstance() : nullptr;
-	FGameplayAbilityLocalAnimMontageForMesh& AnimMontageInfo = GetLocalAnimMontageInfoForMesh(InMesh);
-	if (AnimMontageInfo.LocalMontageInfo.AnimMontage && AnimInstance)
+	UAnimMontage* CurrentAnimMontage = FindLocalMontageForMesh(InMesh);
+	if (CurrentAnimMontage && AnimInstance)
 	{
 		// Set Play Rate
-		AnimInstance->Montage_SetPlayRate(AnimMontageInfo.LocalMontageInfo.AnimMontage, InPlayRate);
+		AnimInstance->Montage_SetPlayRate(CurrentAnimMontage, InPlayRate);
+		InvalidateMontageStateSnapshotForMesh(InMesh);
 
 		// Update replicated version for Simulated Proxies if we are on the server.
 		if (IsOwnerActorAuthoritative())
 		{
 			AnimMontage_UpdateReplicatedDataForMesh(InMesh);
 		}
+		else if (CVarCoalesceMontageControls.GetValueOnGameThread())
+		{
+			FMontageControlForMesh& Control = GetPendingMontageControlForMesh(InMesh, CurrentAnimMontage);
+			Control.bSetPlayRate = true;
+			Control.PlayRate = InPlayRate;
+		}
 		else
 		{
-			ServerCurrentMontageSetPlayRateForMesh(InMesh, AnimMontageInfo.LocalMontageInfo.AnimMontage, InPlayRate);
+			ServerCurrentMontageSetPlayRateForMesh(InMesh, CurrentAnimMontage, InPlayRate);
+			FPlayMontageAdvancedMetrics::Get().RPCs++;
 		}
 	}
 }
 
-bool UPlayMontageAbilitySystemComponent::IsAnimatingAbilityForAnyMesh(const UGameplayAbility* InAbility) const
+void UPlayMontageAbilitySystemComponent::CurrentMontageJumpToSectionForMeshes(
+	const TArray<USkeletalMeshComponent*>& InMeshes, FName SectionName)
 {
-	for (FGameplayAbilityLocalAnimMontageForMesh GameplayAbilityLocalAnimMontageForMesh : LocalAnimMontageInfoForMeshes)
+	if (SectionName == NAME_None)
+	{
+		return;
+	}
+
+	FScopedMontageBatch MontageBatch(this);
+
+	if (IsOwnerActorAuthoritative())
 	{
-		if (GameplayAbilityLocalAnimMontageForMesh.LocalMontageInfo.AnimatingAbility == InAbility)
+		for (USkeletalMeshComponent* InMesh : InMeshes)
 		{
-			return true;
+			UAnimInstance* AnimInstance = IsValid(InMesh) && InMesh->GetOwner() == AbilityActorInfo->AvatarActor ? InMesh->GetAnimInstance() : nullptr;
+			UAnimMontage* CurrentAnimMontage = FindLocalMontageForMesh(InMesh);
+			if (AnimInstance && CurrentAnimMontage)
+			{
+				AnimInstance->Montage_JumpToSection(SectionName, CurrentAnimMontage);
+				InvalidateMontageStateSnapshotForMesh(InMesh);
+				AnimMontage_UpdateReplicatedDataForMesh(InMesh);
+			}
 		}
+		return;
 	}
 
-	return false;
+	// The whole group shares one prediction key, the server accepts or rejects it as a unit
+	FScopedPredictionWindow ScopedPrediction(this, true);
+
+	TArray<USkeletalMeshComponent*> JumpedMeshes;
+	TArray<UAnimMontage*> JumpedMontages;
+	for (USkeletalMeshComponent* InMesh : InMeshes)
+	{
+		UAnimInstance* AnimInstance = IsValid(InMesh) && InMesh->GetOwner() == AbilityActorInfo->AvatarActor ? InMesh->GetAnimInstance() : nullptr;
+		UAnimMontage* CurrentAnimMontage = FindLocalMontageForMesh(InMesh);
+		if (AnimInstance && CurrentAnimMontage)
+		{
+			PredictMontageSectionChangeForMesh(InMesh, CurrentAnimMontage, AnimInstance);
+			AnimInstance->Montage_JumpToSection(SectionName, CurrentAnimMontage);
+			InvalidateMontageStateSnapshotForMesh(InMesh);
+			JumpedMeshes.Add(InMesh);
+			JumpedMontages.Add(CurrentAnimMontage);
+		}
+	}
+
+	if (JumpedMeshes.Num() > 0)
+	{
+		ServerCurrentMontageJumpToSectionNameForMeshes(JumpedMeshes, JumpedMontages, SectionName, ScopedPredictionKey);
+		FPlayMontageAdvancedMetrics::Get().RPCs++;
+	}
 }
 
-UGameplayAbility* UPlayMontageAbilitySystemComponent::GetAnimatingAbilityFromAnyMesh()
+void UPlayMontageAbilitySystemComponent::CurrentMontageSetPlayRateForMeshes(
+	const TArray<USkeletalMeshComponent*>& InMeshes, const TArray<float>& InPlayRates)
 {
-	// Only one ability can be animating for all meshes
-	for (FGameplayAbilityLocalAnimMontageForMesh& GameplayAbilityLocalAnimMontageForMesh : LocalAnimMontageInfoForMeshes)
+	if (!ensureMsgf(InPlayRates.Num() == 1 || InPlayRates.Num() == InMeshes.Num(),
+		TEXT("CurrentMontageSetPlayRateForMeshes expects one play rate, or one per mesh")))
+	{
+		return;
+	}
+
+	FScopedMontageBatch MontageBatch(this);
+
+	const bool bCoalesce = CVarCoalesceMontageControls.GetValueOnGameThread();
+	TArray<USkeletalMeshComponent*> ChangedMeshes;
+	TArray<UAnimMontage*> ChangedMontages;
+	TArray<float> ChangedPlayRates;
+	for (int32 MeshIndex = 0; MeshIndex < InMeshes.Num(); MeshIndex++)
 	{
-		if (GameplayAbilityLocalAnimMontageForMesh.LocalMontageInfo.AnimatingAbility.IsValid())
+		USkeletalMeshComponent* InMesh = InMeshes[MeshIndex];
+		const float InPlayRate = InPlayRates.Num() == 1 ? InPlayRates[0] : InPlayRates[MeshIndex];
+
+		UAnimInstance* AnimInstance = IsValid(InMesh) && InMesh->GetOwner() == AbilityActorInfo->AvatarActor ? InMesh->GetAnimInstance() : nullptr;
+		UAnimMontage* CurrentAnimMontage = FindLocalMontageForMesh(InMesh);
+		if (CurrentAnimMontage && AnimInstance)
 		{
-			return GameplayAbilityLocalAnimMontageForMesh.LocalMontageInfo.AnimatingAbility.Get();
+			AnimInstance->Montage_SetPlayRate(CurrentAnimMontage, InPlayRate);
+			InvalidateMontageStateSnapshotForMesh(InMesh);
+			if (IsOwnerActorAuthoritative())
+			{
+				AnimMontage_UpdateReplicatedDataForMesh(InMesh);
+			}
+			else if (bCoalesce)
+			{
+				// Every mesh goes out in the same coalesced RPC
+				FMontageControlForMesh& Control = GetPendingMontageControlForMesh(InMesh, CurrentAnimMontage);
+				Control.bSetPlayRate = true;
+				Control.PlayRate = InPlayRate;
+			}
+			else
+			{
+				ChangedMeshes.Add(InMesh);
+				ChangedMontages.Add(CurrentAnimMontage);
+				ChangedPlayRates.Add(InPlayRate);
+			}
 		}
 	}
 
-	return nullptr;
+	if (ChangedMeshes.Num() > 0)
+	{
+		ServerCurrentMontageSetPlayRateForMeshes(ChangedMeshes, ChangedMontages, ChangedPlayRates);
+		FPlayMontageAdvancedMetrics::Get().RPCs++;
+	}
 }
 
-UGameplayAbility* UPlayMontageAbilitySystemComponent::GetAnimatingAbilityFromMesh(USkeletalMeshComponent* InMesh)
+void UPlayMontageAbilitySystemComponent::CurrentMontageStopForMeshes(
+	const TArray<USkeletalMeshComponent*>& InMeshes, float OverrideBlendOutTime)
 {
-	FGameplayAbilityLocalAnimMontageForMesh& AnimMontageInfo = GetLocalAnimMontageInfoForMesh(InMesh);
-	return AnimMontageInfo.LocalMontageInfo.AnimatingAbility.IsValid() ? AnimMontageInfo.LocalMontageInfo.AnimatingAbility.Get() : nullptr;
+	FScopedMontageBatch MontageBatch(this);
+	for (USkeletalMeshComponent* InMesh : InMeshes)
+	{
+		CurrentMontageStopForMesh(InMesh, OverrideBlendOutTime);
+	}
 }
 
-TArray<UAnimMontage*> UPlayMontageAbilitySystemComponent::GetCurrentMontages() const
+void UPlayMontageAbilitySystemComponent::BeginMontageBatch()
 {
-	TArray<UAnimMontage*> Montages;
+	MontageBatchDepth++;
+}
+
+void UPlayMontageAbilitySystemComponent::EndMontageBatch()
+{
+	if (!ensure(MontageBatchDepth > 0))
+	{
+		return;
+	}
+
+	if (--MontageBatchDepth == 0 && bMontageBatchNetUpdatePending)
+	{
+		bMontageBatchNetUpdatePending = false;
+		ForceMontageNetUpdate();
+	}
+}
 
-	for (FGameplayAbilityLocalAnimMontageForMesh GameplayAbilityLocalAnimMontageForMesh : LocalAnimMontageInfoForMeshes)
+void UPlayMontageAbilitySystemComponent::ForceMontageNetUpdate()
+{
+	if (MontageBatchDepth > 0)
+	{
+		bMontageBatchNetUpdatePending = true;
+	}
+	else if (AbilityActorInfo->AvatarActor != nullptr)
 	{
-		UAnimInstance* AnimInstance = IsValid(GameplayAbilityLocalAnimMontageForMesh.Mesh) 
-			&& GameplayAbilityLocalAnimMontageForMesh.Mesh->GetOwner() == AbilityActorInfo->AvatarActor ? GameplayAbilityLocalAnimMontageForMesh.Mesh->GetAnimInstance() : nullptr;
+		AbilityActorInfo->AvatarActor->ForceNetUpdate();
+	}
+}
 
-		if (GameplayAbilityLocalAnimMontageForMesh.LocalMontageInfo.AnimMontage && AnimInstance 
-			&& AnimInstance->Montage_IsActive(GameplayAbilityLocalAnimMontageForMesh.LocalMontageInfo.AnimMontage))
+bool UPlayMontageAbilitySystemComponent::IsAnimatingAbilityForAnyMesh(const UGameplayAbility* InAbility) const
+{
+	for (const TUniquePtr<FGameplayAbilityLocalAnimMontageForMesh>& GameplayAbilityLocalAnimMontageForMesh : LocalAnimMontageInfoForMeshes)
+	{
+		if (GameplayAbilityLocalAnimMontageForMesh->LocalMontageInfo.AnimatingAbility == InAbility)
 		{
-			Montages.Add(GameplayAbilityLocalAnimMontageForMesh.LocalMontageInfo.AnimMontage);
+			return true;
 		}
 	}
 
-	return Montages;
+	return false;
 }
 
-UAnimMontage* UPlayMontageAbilitySystemComponent::GetCurrentMontageForMesh(USkeletalMeshComponent* InMesh)
+UGameplayAbility* UPlayMontageAbilitySystemComponent::GetAnimatingAbilityFromAnyMesh()
 {
-	UAnimInstance* AnimInstance = IsValid(InMesh) && InMesh->GetOwner() == AbilityActorInfo->AvatarActor ? InMesh->GetAnimInstance() : nullptr;
-	FGameplayAbilityLocalAnimMontageForMesh& AnimMontageInfo = GetLocalAnimMontageInfoForMesh(InMesh);
-
-	if (AnimMontageInfo.LocalMontageInfo.AnimMontage && AnimInstance
-		&& AnimInstance->Montage_IsActive(AnimMontageInfo.LocalMontageInfo.AnimMontage))
+	// Only one ability can be animating for all meshes
+	for (const TUniquePtr<FGameplayAbilityLocalAnimMontageForMesh>& GameplayAbilityLocalAnimMontageForMesh : LocalAnimMontageInfoForMeshes)
 	{
-		return AnimMontageInfo.LocalMontageInfo.AnimMontage;
+		if (GameplayAbilityLocalAnimMontageForMesh->LocalMontageInfo.AnimatingAbility.IsValid())
+		{
+			return GameplayAbilityLocalAnimMontageForMesh->LocalMontageInfo.AnimatingAbility.Get();
+		}
 	}
 
 	return nullptr;
 }
 
-int32 UPlayMontageAbilitySystemComponent::GetCurrentMontageSectionIDForMesh(USkeletalMeshComponent* InMesh)
+UGameplayAbility* UPlayMontageAbilitySystemComponent::GetAnimatingAbilityFromMesh(USkeletalMeshComponent* InMesh)
 {
-	UAnimInstance* AnimInstance = IsValid(InMesh) && InMesh->GetOwner() == AbilityActorInfo->AvatarActor ? InMesh->GetAnimInstance() : nullptr;
-	UAnimMontage* CurrentAnimMontage = GetCurrentMontageForMesh(InMesh);
+	const FGameplayAbilityLocalAnimMontageForMesh* AnimMontageInfo = FindLocalAnimMontageInfoForMesh(InMesh);
+	return AnimMontageInfo && AnimMontageInfo->LocalMontageInfo.AnimatingAbility.IsValid() ? AnimMontageInfo->LocalMontageInfo.AnimatingAbility.Get() : nullptr;
+}
 
-	if (CurrentAnimMontage && AnimInstance)
+TArray<UAnimMontage*> UPlayMontageAbilitySystemComponent::GetCurrentMontages() const
+{
+	TArray<UAnimMontage*> Montages;
+	Montages.Reserve(LocalAnimMontageInfoForMeshes.Num());
+	CollectCurrentMontages(Montages);
+	return Montages;
+}
+
+int32 UPlayMontageAbilitySystemComponent::GetNumCurrentMontages() const
+{
+	int32 NumMontages = 0;
+	ForEachCurrentMontage([&NumMontages](USkeletalMeshComponent*, UAnimMontage*)
 	{
-		float MontagePosition = AnimInstance->Montage_GetPosition(CurrentAnimMontage);
-		return CurrentAnimMontage->GetSectionIndexFromPosition(MontagePosition);
-	}
+		NumMontages++;
+	});
+	return NumMontages;
+}
 
-	return INDEX_NONE;
+UAnimMontage* UPlayMontageAbilitySystemComponent::GetCurrentMontageForMesh(USkeletalMeshComponent* InMesh)
+{
+	const FMontageStateSnapshot* Snapshot = GetMontageStateSnapshotForMesh(InMesh);
+	return Snapshot && Snapshot->bIsActive ? Snapshot->Montage : nullptr;
 }
 
-FName UPlayMontageAbilitySystemComponent::GetCurrentMontageSectionNameForMesh(USkeletalMeshComponent* InMesh)
+int32 UPlayMontageAbilitySystemComponent::GetCurrentMontageSectionIDForMesh(USkeletalMeshComponent* InMesh)
 {
-	UAnimInstance* AnimInstance = IsValid(InMesh) && InMesh->GetOwner() == AbilityActorInfo->AvatarActor ? InMesh->GetAnimInstance() : nullptr;
-	UAnimMontage* CurrentAnimMontage = GetCurrentMontageForMesh(InMesh);
+	const FMontageStateSnapshot* Snapshot = GetMontageStateSnapshotForMesh(InMesh);
+	return Snapshot && Snapshot->bIsActive ? Snapshot->SectionIndex : INDEX_NONE;
+}
 
-	if (CurrentAnimMontage && AnimInstance)
+FName UPlayMontageAbilitySystemComponent::GetCurrentMontageSectionNameForMesh(USkeletalMeshComponent* InMesh)
+{
+	const FMontageStateSnapshot* Snapshot = GetMontageStateSnapshotForMesh(InMesh);
+	if (Snapshot && Snapshot->bIsActive)
 	{
-		float MontagePosition = AnimInstance->Montage_GetPosition(CurrentAnimMontage);
-		int32 CurrentSectionID = CurrentAnimMontage->GetSectionIndexFromPosition(MontagePosition);
-
-		return CurrentAnimMontage->GetSectionName(CurrentSectionID);
+		return FMontageSectionCache::Get(Snapshot->Montage).GetSectionName(Snapshot->SectionIndex);
 	}
 
 	return NAME_None;
@@ -389,30 +1148,19 @@ FName UPlayMontageAbilitySystemComponent::GetCurrentMontageSectionNameForMesh(US
 
 float UPlayMontageAbilitySystemComponent::GetCurrentMontageSectionLengthForMesh(USkeletalMeshComponent* InMesh)
 {
-	UAnimInstance* AnimInstance = IsValid(InMesh) && InMesh->GetOwner() == AbilityActorInfo->AvatarActor ? InMesh->GetAnimInstance() : nullptr;
-	UAnimMontage* CurrentAnimMontage = GetCurrentMontageForMesh(InMesh);
-
-	if (CurrentAnimMontage && AnimInstance)
+	const FMontageStateSnapshot* Snapshot = GetMontageStateSnapshotForMesh(InMesh);
+	if (Snapshot && Snapshot->bIsActive)
 	{
-		int32 CurrentSectionID = GetCurrentMontageSectionIDForMesh(InMesh);
+		const FMontageSectionCache& SectionCache = FMontageSectionCache::Get(Snapshot->Montage);
+		int32 CurrentSectionID = Snapshot->SectionIndex;
 		if (CurrentSectionID != INDEX_NONE)
 		{
-			TArray<FCompositeSection>& CompositeSections = CurrentAnimMontage->CompositeSections;
-
-			// If we have another section after us, then take delta between both start times.
-			if (CurrentSectionID < (CompositeSections.Num() - 1))
-			{
-				return (CompositeSections[CurrentSectionID + 1].GetTime() - CompositeSections[CurrentSectionID].GetTime());
-			}
-			// Otherwise we are the last section, so take delta with Montage total time.
-			else
-			{
-				return (CurrentAnimMontage->GetPlayLength() - CompositeSections[CurrentSectionID].GetTime());
-			}
+			// Delta to the next section's start time, or to the Montage total time for the last section.
+			return SectionCache.GetSectionLength(CurrentSectionID);
 		}
 
 		// if we have no sections, just return total length of Montage.
-		return CurrentAnimMontage->GetPlayLength();
+		return SectionCache.PlayLength;
 	}
 
 	return 0.f;
@@ -420,250 +1168,719 @@ float UPlayMontageAbilitySystemComponent::GetCurrentMontageSectionLengthForMesh(
 
 float UPlayMontageAbilitySystemComponent::GetCurrentMontageSectionTimeLeftForMesh(USkeletalMeshComponent* InMesh)
 {
-	UAnimInstance* AnimInstance = IsValid(InMesh) && InMesh->GetOwner() == AbilityActorInfo->AvatarActor ? InMesh->GetAnimInstance() : nullptr;
-	UAnimMontage* CurrentAnimMontage = GetCurrentMontageForMesh(InMesh);
-
-	if (CurrentAnimMontage && AnimInstance && AnimInstance->Montage_IsActive(CurrentAnimMontage))
+	const FMontageStateSnapshot* Snapshot = GetMontageStateSnapshotForMesh(InMesh);
+	if (Snapshot && Snapshot->bIsActive)
 	{
-		const float CurrentPosition = AnimInstance->Montage_GetPosition(CurrentAnimMontage);
-		return CurrentAnimMontage->GetSectionTimeLeftFromPos(CurrentPosition);
+		return FMontageSectionCache::Get(Snapshot->Montage).GetSectionTimeLeftFromPosition(Snapshot->Position);
 	}
 
 	return -1.f;
 }
 
-FGameplayAbilityLocalAnimMontageForMesh& UPlayMontageAbilitySystemComponent::GetLocalAnimMontageInfoForMesh(
-	USkeletalMeshComponent* InMesh)
+const FMontageStateSnapshot* UPlayMontageAbilitySystemComponent::GetMontageStateSnapshotForMesh(
+	const USkeletalMeshComponent* InMesh) const
+{
+	const int32* SlotIndex = LocalAnimMontageSlotIndices.Find(InMesh);
+	return SlotIndex ? &GetMontageStateSnapshot(*LocalAnimMontageInfoForMeshes[*SlotIndex]) : nullptr;
+}
+
+void UPlayMontageAbilitySystemComponent::InvalidateMontageStateSnapshotForMesh(const USkeletalMeshComponent* InMesh)
 {
-	for (FGameplayAbilityLocalAnimMontageForMesh& MontageInfo : LocalAnimMontageInfoForMeshes)
+	if (const FGameplayAbilityLocalAnimMontageForMesh* AnimMontageInfo = FindLocalAnimMontageInfoForMesh(InMesh))
 	{
-		if (MontageInfo.Mesh == InMesh)
-		{
-			return MontageInfo;
-		}
+		AnimMontageInfo->StateSnapshot.Frame = MAX_uint64;
 	}
-
-	FGameplayAbilityLocalAnimMontageForMesh MontageInfo = FGameplayAbilityLocalAnimMontageForMesh(InMesh);
-	LocalAnimMontageInfoForMeshes.Add(MontageInfo);
-	return LocalAnimMontageInfoForMeshes.Last();
 }
 
-FGameplayAbilityRepAnimMontageForMesh& UPlayMontageAbilitySystemComponent::GetGameplayAbilityRepAnimMontageForMesh(
-	USkeletalMeshComponent* InMesh)
+void UPlayMontageAbilitySystemComponent::InvalidateMontageStateSnapshots()
 {
-	for (FGameplayAbilityRepAnimMontageForMesh& RepMontageInfo : RepAnimMontageInfoForMeshes)
+	for (const TUniquePtr<FGameplayAbilityLocalAnimMontageForMesh>& AnimMontageInfo : LocalAnimMontageInfoForMeshes)
 	{
-		if (RepMontageInfo.Mesh == InMesh)
-		{
-			return RepMontageInfo;
-		}
+		AnimMontageInfo->StateSnapshot.Frame = MAX_uint64;
 	}
-
-	FGameplayAbilityRepAnimMontageForMesh RepMontageInfo = FGameplayAbilityRepAnimMontageForMesh(InMesh);
-	RepAnimMontageInfoForMeshes.Add(RepMontageInfo);
-	return RepAnimMontageInfoForMeshes.Last();
 }
 
-void UPlayMontageAbilitySystemComponent::OnPredictiveMontageRejectedForMesh(USkeletalMeshComponent* InMesh,
-	UAnimMontage* PredictiveMontage)
+void UPlayMontageAbilitySystemComponent::BindMontageStateSnapshotInvalidationForMesh(USkeletalMeshComponent* InMesh)
 {
-	static constexpr float MONTAGE_PREDICTION_REJECT_FADETIME = 0.25f;
+	if (IsStaleMesh(InMesh))
+	{
+		return;
+	}
 
-	UAnimInstance* AnimInstance = IsValid(InMesh) && InMesh->GetOwner() == AbilityActorInfo->AvatarActor ? InMesh->GetAnimInstance() : nullptr;
-	if (AnimInstance && PredictiveMontage)
+	// The anim instance is replaced when the mesh or anim class changes, bind again to the new one
+	InMesh->OnAnimInitialized.AddUniqueDynamic(this, &ThisClass::OnMeshAnimInitialized);
+
+	// The montage can be changed after the pose ticked, by anim notifies, gameplay code or the graph itself
+	InMesh->OnBoneTransformsFinalized.AddUniqueDynamic(this, &ThisClass::OnMeshBoneTransformsFinalized);
+
+	if (UAnimInstance* AnimInstance = InMesh->GetAnimInstance())
 	{
-		// If this montage is still playing: kill it
-		if (AnimInstance->Montage_IsPlaying(PredictiveMontage))
-		{
-			AnimInstance->Montage_Stop(MONTAGE_PREDICTION_REJECT_FADETIME, PredictiveMontage);
-		}
+		AnimInstance->OnMontageStarted.AddUniqueDynamic(this, &ThisClass::OnAnimInstanceMontageStarted);
+		AnimInstance->OnMontageBlendingOut.AddUniqueDynamic(this, &ThisClass::OnAnimInstanceMontageStopped);
+		AnimInstance->OnMontageEnded.AddUniqueDynamic(this, &ThisClass::OnAnimInstanceMontageStopped);
 	}
 }
 
-void UPlayMontageAbilitySystemComponent::AnimMontage_UpdateReplicatedDataForMesh(USkeletalMeshComponent* InMesh)
+void UPlayMontageAbilitySystemComponent::OnAnimInstanceMontageStarted(UAnimMontage* Montage)
 {
-	check(IsOwnerActorAuthoritative());
+	InvalidateMontageStateSnapshots();
+}
 
-	AnimMontage_UpdateReplicatedDataForMesh(GetGameplayAbilityRepAnimMontageForMesh(InMesh));
+void UPlayMontageAbilitySystemComponent::OnAnimInstanceMontageStopped(UAnimMontage* Montage, bool bInterrupted)
+{
+	InvalidateMontageStateSnapshots();
 }
 
-void UPlayMontageAbilitySystemComponent::AnimMontage_UpdateReplicatedDataForMesh(
-	FGameplayAbilityRepAnimMontageForMesh& OutRepAnimMontageInfo)
+void UPlayMontageAbilitySystemComponent::OnMeshBoneTransformsFinalized()
 {
-	UAnimInstance* AnimInstance = IsValid(OutRepAnimMontageInfo.Mesh) && OutRepAnimMontageInfo.Mesh->GetOwner() 
-		== AbilityActorInfo->AvatarActor ? OutRepAnimMontageInfo.Mesh->GetAnimInstance() : nullptr;
-	FGameplayAbilityLocalAnimMontageForMesh& AnimMontageInfo = GetLocalAnimMontageInfoForMesh(OutRepAnimMontageInfo.Mesh);
+	InvalidateMontageStateSnapshots();
+}
 
-	if (AnimInstance && AnimMontageInfo.LocalMontageInfo.AnimMontage)
+void UPlayMontageAbilitySystemComponent::OnMeshAnimInitialized()
+{
+	InvalidateMontageStateSnapshots();
+	for (const TUniquePtr<FGameplayAbilityLocalAnimMontageForMesh>& AnimMontageInfo : LocalAnimMontageInfoForMeshes)
 	{
-		OutRepAnimMontageInfo.RepMontageInfo.Animation = AnimMontageInfo.LocalMontageInfo.AnimMontage;
+		BindMontageStateSnapshotInvalidationForMesh(AnimMontageInfo->Mesh.Get());
+	}
+}
 
-		// Compressed Flags
-		bool bIsStopped = AnimInstance->Montage_GetIsStopped(AnimMontageInfo.LocalMontageInfo.AnimMontage);
+const FMontageStateSnapshot& UPlayMontageAbilitySystemComponent::GetMontageStateSnapshot(
+	const FGameplayAbilityLocalAnimMontageForMesh& AnimMontageInfo) const
+{
+	ComputeMontageStateSnapshot(AnimMontageInfo, AnimMontageInfo.StateSnapshot);
+	return AnimMontageInfo.StateSnapshot;
+}
 
-		if (!bIsStopped)
+void UPlayMontageAbilitySystemComponent::ComputeMontageStateSnapshot(
+	const FGameplayAbilityLocalAnimMontageForMesh& AnimMontageInfo, FMontageStateSnapshot& OutSnapshot) const
+{
+	const FMontageStateSnapshot& CachedSnapshot = AnimMontageInfo.StateSnapshot;
+	const USkeletalMeshComponent* Mesh = AnimMontageInfo.Mesh.Get();
+	const bool bPoseTicked = IsValid(Mesh) && Mesh->PoseTickedThisFrame();
+	if (CachedSnapshot.Frame == GFrameCounter && CachedSnapshot.bPoseTicked == bPoseTicked)
+	{
+		if (&OutSnapshot != &CachedSnapshot)
 		{
-			OutRepAnimMontageInfo.RepMontageInfo.PlayRate = AnimInstance->Montage_GetPlayRate(AnimMontageInfo.LocalMontageInfo.AnimMontage);
-			OutRepAnimMontageInfo.RepMontageInfo.Position = AnimInstance->Montage_GetPosition(AnimMontageInfo.LocalMontageInfo.AnimMontage);
-			OutRepAnimMontageInfo.RepMontageInfo.BlendTime = AnimInstance->Montage_GetBlendTime(AnimMontageInfo.LocalMontageInfo.AnimMontage);
+			OutSnapshot = CachedSnapshot;
 		}
+		return;
+	}
 
-		if (OutRepAnimMontageInfo.RepMontageInfo.IsStopped != bIsStopped)
-		{
-			// Set this prior to calling UpdateShouldTick, so we start ticking if we are playing a Montage
-			OutRepAnimMontageInfo.RepMontageInfo.IsStopped = bIsStopped;
+	OutSnapshot = FMontageStateSnapshot();
+	OutSnapshot.Frame = GFrameCounter;
+	OutSnapshot.bPoseTicked = bPoseTicked;
+	OutSnapshot.AnimInstance = IsValid(Mesh) && Mesh->GetOwner() == AbilityActorInfo->AvatarActor ? Mesh->GetAnimInstance() : nullptr;
+	OutSnapshot.Montage = AnimMontageInfo.LocalMontageInfo.AnimMontage;
 
-			// When we start or stop an animation, update the clients right away for the Avatar Actor
-			if (AbilityActorInfo->AvatarActor != nullptr)
-			{
-				AbilityActorInfo->AvatarActor->ForceNetUpdate();
-			}
+	// Single montage instance lookup, the values match what the Montage_Get* accessors return
+	const FAnimMontageInstance* MontageInstance = OutSnapshot.AnimInstance && OutSnapshot.Montage ? OutSnapshot.AnimInstance->GetActiveInstanceForMontage(OutSnapshot.Montage) : nullptr;
+	if (MontageInstance)
+	{
+		OutSnapshot.bIsActive = true;
+		OutSnapshot.bIsStopped = MontageInstance->IsStopped();
+		OutSnapshot.Position = MontageInstance->GetPosition();
+		OutSnapshot.PlayRate = MontageInstance->GetPlayRate();
+		OutSnapshot.SectionIndex = FMontageSectionCache::FindSectionIndexFromPosition(OutSnapshot.Montage, OutSnapshot.Position);
+	}
+}
 
-			// When this changes, we should update whether or not we should be ticking
-			UpdateShouldTick();
-		}
+int32 UPlayMontageAbilitySystemComponent::RegisterLocalAnimMontageSlotForMesh(USkeletalMeshComponent* InMesh)
+{
+	if (const int32* SlotIndex = LocalAnimMontageSlotIndices.Find(InMesh))
+	{
+		return *SlotIndex;
+	}
 
-		// Replicate NextSectionID to keep it in sync.
-		// We actually replicate NextSectionID+1 on a BYTE to put INDEX_NONE in there.
-		int32 CurrentSectionID = AnimMontageInfo.LocalMontageInfo.AnimMontage->GetSectionIndexFromPosition(OutRepAnimMontageInfo.RepMontageInfo.Position);
-		if (CurrentSectionID != INDEX_NONE)
-		{
-			int32 NextSectionID = AnimInstance->Montage_GetNextSectionID(AnimMontageInfo.LocalMontageInfo.AnimMontage, CurrentSectionID);
-			if (NextSectionID >= (256 - 1))
-			{
-				ABILITY_LOG(Error, TEXT("AnimMontage_UpdateReplicatedData. NextSectionID = %d.  RepAnimMontageInfo.Position: %.2f, CurrentSectionID: %d. LocalAnimMontageInfo.AnimMontage %s"),
-					NextSectionID, OutRepAnimMontageInfo.RepMontageInfo.Position, CurrentSectionID, *GetNameSafe(AnimMontageInfo.LocalMontageInfo.AnimMontage));
-				ensure(NextSectionID < (256 - 1));
-			}
-			OutRepAnimMontageInfo.RepMontageInfo.NextSectionID = uint8(NextSectionID + 1);
-		}
-		else
+	// Meshes come and go with weapon swaps and attachments, reuse the slot of one that was pruned before growing
+	// Stale slots are only reclaimed here, tombstoning keeps every other slot's address so no reference is invalidated
+	if (FreeLocalAnimMontageSlots.Num() == 0)
+	{
+		CountPrunedMeshEntries(PruneStaleLocalAnimMontageSlots());
+	}
+
+	int32 SlotIndex;
+	if (FreeLocalAnimMontageSlots.Num() > 0)
+	{
+		SlotIndex = FreeLocalAnimMontageSlots.Pop();
+		*LocalAnimMontageInfoForMeshes[SlotIndex] = FGameplayAbilityLocalAnimMontageForMesh(InMesh);
+	}
+	else
+	{
+		SlotIndex = LocalAnimMontageInfoForMeshes.Add(MakeUnique<FGameplayAbilityLocalAnimMontageForMesh>(InMesh));
+	}
+	LocalAnimMontageSlotIndices.Add(InMesh, SlotIndex);
+	BindMontageStateSnapshotInvalidationForMesh(InMesh);
+	return SlotIndex;
+}
+
+int32 UPlayMontageAbilitySystemComponent::PruneStaleLocalAnimMontageSlots()
+{
+	int32 NumRemoved = 0;
+	for (auto It = LocalAnimMontageSlotIndices.CreateIterator(); It; ++It)
+	{
+		FGameplayAbilityLocalAnimMontageForMesh& AnimMontageInfo = *LocalAnimMontageInfoForMeshes[It.Value()];
+		if (IsStaleMesh(AnimMontageInfo.Mesh.Get()))
 		{
-			OutRepAnimMontageInfo.RepMontageInfo.NextSectionID = 0;
+			// Tombstone the slot in place, it keeps its address and index until a new mesh reuses it
+			AnimMontageInfo = FGameplayAbilityLocalAnimMontageForMesh();
+			FreeLocalAnimMontageSlots.Add(It.Value());
+			It.RemoveCurrent();
+			NumRemoved++;
 		}
 	}
+	return NumRemoved;
 }
 
-void UPlayMontageAbilitySystemComponent::AnimMontage_UpdateForcedPlayFlagsForMesh(
-	FGameplayAbilityRepAnimMontageForMesh& OutRepAnimMontageInfo)
+bool UPlayMontageAbilitySystemComponent::IsStaleMesh(const USkeletalMeshComponent* InMesh)
 {
-	FGameplayAbilityLocalAnimMontageForMesh& AnimMontageInfo = GetLocalAnimMontageInfoForMesh(OutRepAnimMontageInfo.Mesh);
+	return !IsValid(InMesh) || !InMesh->IsRegistered();
 }
 
-void UPlayMontageAbilitySystemComponent::OnRep_ReplicatedAnimMontageForMesh()
+int32 UPlayMontageAbilitySystemComponent::PruneStaleRepAnimMontageItems()
 {
-	for (FGameplayAbilityRepAnimMontageForMesh& NewRepMontageInfoForMesh : RepAnimMontageInfoForMeshes)
+	// Removing replicated items is server authoritative, clients drop them when the removal replicates
+	if (!IsOwnerActorAuthoritative())
 	{
-		FGameplayAbilityLocalAnimMontageForMesh& AnimMontageInfo = GetLocalAnimMontageInfoForMesh(NewRepMontageInfoForMesh.Mesh);
+		return 0;
+	}
 
-		UWorld* World = GetWorld();
+	const int32 NumRemoved = RepAnimMontageInfoForMeshes.RemoveStaleItems();
+	if (NumRemoved > 0)
+	{
+		// The removed items may have been the only playing ones keeping us ticking
+		UpdateShouldTick();
+	}
+	CountPrunedMeshEntries(NumRemoved);
+	return NumRemoved;
+}
 
-		if (NewRepMontageInfoForMesh.RepMontageInfo.bSkipPlayRate)
-		{
-			NewRepMontageInfoForMesh.RepMontageInfo.PlayRate = 1.f;
-		}
+void UPlayMontageAbilitySystemComponent::CountPrunedMeshEntries(int32 NumRemoved)
+{
+	if (NumRemoved > 0)
+	{
+		INC_DWORD_STAT_BY(STAT_MontageMeshEntries_Pruned, NumRemoved);
+		FPlayMontageAdvancedMetrics::Get().PrunedMeshEntries += NumRemoved;
+	}
+}
 
-		const bool bIsPlayingReplay = World && World->IsPlayingReplay();
+int32 UPlayMontageAbilitySystemComponent::PruneStaleMeshEntries()
+{
+	const int32 NumLocalSlotsRemoved = PruneStaleLocalAnimMontageSlots();
+	CountPrunedMeshEntries(NumLocalSlotsRemoved);
 
-		const float MONTAGE_REP_POS_ERR_THRESH = bIsPlayingReplay ? CVarReplayMontageErrorThreshold.GetValueOnGameThread() : 0.1f;
+	const int32 NumWarpsRemoved = MontagePositionWarps.RemoveAllSwap([](const FMontagePositionWarpForMesh& Warp)
+	{
+		return IsStaleMesh(Warp.Mesh);
+	});
+	if (NumWarpsRemoved > 0 && MontagePositionWarps.Num() == 0)
+	{
+		UpdateShouldTick();
+	}
+	CountPrunedMeshEntries(NumWarpsRemoved);
 
-		UAnimInstance* AnimInstance = IsValid(NewRepMontageInfoForMesh.Mesh) && NewRepMontageInfoForMesh.Mesh->GetOwner()
-			== AbilityActorInfo->AvatarActor ? NewRepMontageInfoForMesh.Mesh->GetAnimInstance() : nullptr;
-		if (AnimInstance == nullptr || !IsReadyForReplicatedMontageForMesh())
-		{
-			// We can't handle this yet
-			bPendingMontageRep = true;
-			return;
-		}
-		bPendingMontageRep = false;
+	return NumLocalSlotsRemoved + PruneStaleRepAnimMontageItems() + NumWarpsRemoved;
+}
 
-		if (!AbilityActorInfo->IsLocallyControlled())
-		{
-			static const auto CVar = IConsoleManager::Get().FindTConsoleVariableDataInt(TEXT("net.Montage.Debug"));
-			bool DebugMontage = (CVar && CVar->GetValueOnGameThread() == 1);
-			if (DebugMontage)
-			{
-				ABILITY_LOG(Warning, TEXT("\n\nOnRep_ReplicatedAnimMontage, %s"), *GetNameSafe(this));
-				ABILITY_LOG(Warning, TEXT("\tAnimMontage: %s\n\tPlayRate: %f\n\tPosition: %f\n\tBlendTime: %f\n\tNextSectionID: %d\n\tIsStopped: %d"),
-					*GetNameSafe(NewRepMontageInfoForMesh.RepMontageInfo.Animation),
-					NewRepMontageInfoForMesh.RepMontageInfo.PlayRate,
-					NewRepMontageInfoForMesh.RepMontageInfo.Position,
-					NewRepMontageInfoForMesh.RepMontageInfo.BlendTime,
-					NewRepMontageInfoForMesh.RepMontageInfo.NextSectionID,
-					NewRepMontageInfoForMesh.RepMontageInfo.IsStopped);
-				ABILITY_LOG(Warning, TEXT("\tLocalAnimMontageInfo.AnimMontage: %s\n\tPosition: %f"),
-					*GetNameSafe(AnimMontageInfo.LocalMontageInfo.AnimMontage), AnimInstance->Montage_GetPosition(AnimMontageInfo.LocalMontageInfo.AnimMontage));
-			}
+int32 UPlayMontageAbilitySystemComponent::GetNumMeshEntries() const
+{
+	return LocalAnimMontageSlotIndices.Num() + RepAnimMontageInfoForMeshes.Items.Num() + MontageReplayEvents.Num() + MontagePositionWarps.Num();
+}
 
-			if (NewRepMontageInfoForMesh.RepMontageInfo.Animation)
-			{
-				// New Montage to play
-				if ((AnimMontageInfo.LocalMontageInfo.AnimMontage != NewRepMontageInfoForMesh.RepMontageInfo.Animation))
-				{
-					PlayMontageSimulatedForMesh(NewRepMontageInfoForMesh.Mesh,
-						NewRepMontageInfoForMesh.RepMontageInfo.GetAnimMontage(), NewRepMontageInfoForMesh.RepMontageInfo.PlayRate,
-						NewRepMontageInfoForMesh.RepMontageInfo.bOverrideBlendIn, NewRepMontageInfoForMesh.RepMontageInfo.BlendInOverride);
-				}
+SIZE_T UPlayMontageAbilitySystemComponent::GetMeshEntriesAllocatedSize() const
+{
+	return LocalAnimMontageInfoForMeshes.GetAllocatedSize()
+		+ LocalAnimMontageInfoForMeshes.Num() * sizeof(FGameplayAbilityLocalAnimMontageForMesh)
+		+ LocalAnimMontageSlotIndices.GetAllocatedSize()
+		+ FreeLocalAnimMontageSlots.GetAllocatedSize()
+		+ RepAnimMontageInfoForMeshes.Items.GetAllocatedSize()
+		+ RepAnimMontageInfoForMeshes.ItemIndices.GetAllocatedSize()
+		+ MontageReplayEvents.GetAllocatedSize()
+		+ MontagePositionWarps.GetAllocatedSize();
+}
 
-				if (AnimMontageInfo.LocalMontageInfo.AnimMontage == nullptr)
-				{
-					ABILITY_LOG(Warning, TEXT("OnRep_ReplicatedAnimMontage: PlayMontageSimulated failed. Name: %s, AnimMontage: %s"), *GetNameSafe(this), *GetNameSafe(NewRepMontageInfoForMesh.RepMontageInfo.GetAnimMontage()));
-					return;
-				}
+void UPlayMontageAbilitySystemComponent::RegisterLocalAnimMontageSlotsForAvatar()
+{
+	AActor* AvatarActor = AbilityActorInfo.IsValid() ? AbilityActorInfo->AvatarActor.Get() : nullptr;
+	if (!AvatarActor)
+	{
+		return;
+	}
 
-				// Play Rate has changed
-				if (AnimInstance->Montage_GetPlayRate(AnimMontageInfo.LocalMontageInfo.AnimMontage) != NewRepMontageInfoForMesh.RepMontageInfo.PlayRate)
-				{
-					AnimInstance->Montage_SetPlayRate(AnimMontageInfo.LocalMontageInfo.AnimMontage, NewRepMontageInfoForMesh.RepMontageInfo.PlayRate);
-				}
+	TInlineComponentArray<USkeletalMeshComponent*> Meshes(AvatarActor);
+	LocalAnimMontageInfoForMeshes.Reserve(LocalAnimMontageInfoForMeshes.Num() + Meshes.Num());
+	for (USkeletalMeshComponent* Mesh : Meshes)
+	{
+		RegisterLocalAnimMontageSlotForMesh(Mesh);
 
-				// Compressed Flags
-				const bool bIsStopped = AnimInstance->Montage_GetIsStopped(AnimMontageInfo.LocalMontageInfo.AnimMontage);
-				const bool bReplicatedIsStopped = bool(NewRepMontageInfoForMesh.RepMontageInfo.IsStopped);
+		// Existing slots may have a new anim instance
+		BindMontageStateSnapshotInvalidationForMesh(Mesh);
+	}
+}
 
-				// Process stopping first, so we don't change sections and cause blending to pop.
-				if (bReplicatedIsStopped)
-				{
-					if (!bIsStopped)
-					{
-						CurrentMontageStopForMesh(NewRepMontageInfoForMesh.Mesh, NewRepMontageInfoForMesh.RepMontageInfo.BlendTime);
-					}
-				}
-				else if (!NewRepMontageInfoForMesh.RepMontageInfo.SkipPositionCorrection)
-				{
-					const int32 RepSectionID = AnimMontageInfo.LocalMontageInfo.AnimMontage->GetSectionIndexFromPosition(NewRepMontageInfoForMesh.RepMontageInfo.Position);
-					const int32 RepNextSectionID = int32(NewRepMontageInfoForMesh.RepMontageInfo.NextSectionID) - 1;
+FGameplayAbilityLocalAnimMontageForMesh& UPlayMontageAbilitySystemComponent::GetLocalAnimMontageInfoForMesh(
+	USkeletalMeshComponent* InMesh)
+{
+	return *LocalAnimMontageInfoForMeshes[RegisterLocalAnimMontageSlotForMesh(InMesh)];
+}
 
-					// And NextSectionID for the replicated SectionID.
-					if (RepSectionID != INDEX_NONE)
-					{
-						const int32 NextSectionID = AnimInstance->Montage_GetNextSectionID(AnimMontageInfo.LocalMontageInfo.AnimMontage, RepSectionID);
+FGameplayAbilityLocalAnimMontageForMesh* UPlayMontageAbilitySystemComponent::FindLocalAnimMontageInfoForMesh(
+	const USkeletalMeshComponent* InMesh)
+{
+	const int32* SlotIndex = LocalAnimMontageSlotIndices.Find(InMesh);
+	return SlotIndex ? LocalAnimMontageInfoForMeshes[*SlotIndex].Get() : nullptr;
+}
 
-						// If NextSectionID is different from the replicated one, then set it.
-						if (NextSectionID != RepNextSectionID)
-						{
-							AnimInstance->Montage_SetNextSection(AnimMontageInfo.LocalMontageInfo.AnimMontage->GetSectionName(RepSectionID), AnimMontageInfo.LocalMontageInfo.AnimMontage->GetSectionName(RepNextSectionID), AnimMontageInfo.LocalMontageInfo.AnimMontage);
-						}
+UAnimMontage* UPlayMontageAbilitySystemComponent::FindLocalMontageForMesh(const USkeletalMeshComponent* InMesh)
+{
+	const FGameplayAbilityLocalAnimMontageForMesh* AnimMontageInfo = FindLocalAnimMontageInfoForMesh(InMesh);
+	return AnimMontageInfo ? AnimMontageInfo->LocalMontageInfo.AnimMontage : nullptr;
+}
 
-						// Make sure we haven't received that update too late and the client hasn't already jumped to another section. 
-						const int32 CurrentSectionID = AnimMontageInfo.LocalMontageInfo.AnimMontage->GetSectionIndexFromPosition(AnimInstance->Montage_GetPosition(AnimMontageInfo.LocalMontageInfo.AnimMontage));
-						if ((CurrentSectionID != RepSectionID) && (CurrentSectionID != RepNextSectionID))
-						{
-							// Client is in a wrong section, teleport him into the begining of the right section
-							const float SectionStartTime = AnimMontageInfo.LocalMontageInfo.AnimMontage->GetAnimCompositeSection(RepSectionID).GetTime();
-							AnimInstance->Montage_SetPosition(AnimMontageInfo.LocalMontageInfo.AnimMontage, SectionStartTime);
-						}
+FGameplayAbilityRepAnimMontageForMesh& UPlayMontageAbilitySystemComponent::GetGameplayAbilityRepAnimMontageForMesh(
+	USkeletalMeshComponent* InMesh)
+{
+	if (FGameplayAbilityRepAnimMontageForMesh* RepMontageInfo = RepAnimMontageInfoForMeshes.FindItemForMesh(InMesh))
+	{
+		return *RepMontageInfo;
+	}
+
+	return RepAnimMontageInfoForMeshes.AddItemForMesh(InMesh);
+}
+
+FGameplayAbilityRepAnimMontageForMesh* UPlayMontageAbilitySystemComponent::FindGameplayAbilityRepAnimMontageForMesh(
+	USkeletalMeshComponent* InMesh)
+{
+	return RepAnimMontageInfoForMeshes.FindItemForMesh(InMesh);
+}
+
+void UPlayMontageAbilitySystemComponent::OnPredictiveMontageRejectedForMesh(USkeletalMeshComponent* InMesh,
+	UAnimMontage* PredictiveMontage)
+{
+	static constexpr float MONTAGE_PREDICTION_REJECT_FADETIME = 0.25f;
+
+	UAnimInstance* AnimInstance = IsValid(InMesh) && InMesh->GetOwner() == AbilityActorInfo->AvatarActor ? InMesh->GetAnimInstance() : nullptr;
+	if (AnimInstance && PredictiveMontage)
+	{
+		// If this montage is still playing: kill it
+		if (AnimInstance->Montage_IsPlaying(PredictiveMontage))
+		{
+			AnimInstance->Montage_Stop(MONTAGE_PREDICTION_REJECT_FADETIME, PredictiveMontage);
+			InvalidateMontageStateSnapshotForMesh(InMesh);
+		}
+	}
+}
+
+void UPlayMontageAbilitySystemComponent::PredictMontageSectionChangeForMesh(USkeletalMeshComponent* InMesh,
+	UAnimMontage* Montage, UAnimInstance* AnimInstance)
+{
+	FPredictionKey PredictionKey = GetPredictionKeyForNewAction();
+	FAnimMontageInstance* MontageInstance = AnimInstance->GetActiveInstanceForMontage(Montage);
+	if (!PredictionKey.IsValidKey() || !MontageInstance)
+	{
+		return;
+	}
+
+	// Snapshot what the section change is about to overwrite, only restored if the key is rejected
+	const double PredictionWorldTime = GetWorld() ? GetWorld()->GetTimeSeconds() : 0.0;
+	PredictionKey.NewRejectedDelegate().BindUObject(this, &ThisClass::OnPredictiveMontageSectionRejectedForMesh, InMesh, Montage,
+		MontageInstance->GetPosition(), MontageInstance->NextSections, PredictionWorldTime);
+}
+
+void UPlayMontageAbilitySystemComponent::OnPredictiveMontageSectionRejectedForMesh(USkeletalMeshComponent* InMesh,
+	UAnimMontage* PredictiveMontage, float PriorPosition, TArray<int32> PriorNextSections, double PredictionWorldTime)
+{
+	static constexpr float MONTAGE_SECTION_PREDICTION_REJECT_BLENDTIME = 0.2f;
+
+	UAnimInstance* AnimInstance = IsValid(InMesh) && InMesh->GetOwner() == AbilityActorInfo->AvatarActor ? InMesh->GetAnimInstance() : nullptr;
+	FAnimMontageInstance* MontageInstance = AnimInstance && PredictiveMontage ? AnimInstance->GetActiveInstanceForMontage(PredictiveMontage) : nullptr;
+
+	// Nothing to restore if the montage was stopped or replaced in the meantime
+	if (!MontageInstance || !MontageInstance->IsPlaying() || MontageInstance->NextSections.Num() != PriorNextSections.Num())
+	{
+		return;
+	}
+
+	// Restore the section links the prediction overwrote
+	for (int32 SectionIndex = 0; SectionIndex < PriorNextSections.Num(); SectionIndex++)
+	{
+		MontageInstance->SetNextSectionID(SectionIndex, PriorNextSections[SectionIndex]);
+	}
+
+	// Continue from where the prior section would be by now, a rejected next section we haven't reached yet needs no correction
+	const FMontageSectionCache& SectionCache = FMontageSectionCache::Get(PredictiveMontage);
+	const int32 PriorSectionIndex = SectionCache.GetSectionIndexFromPosition(PriorPosition);
+	const int32 CurrentSectionIndex = SectionCache.GetSectionIndexFromPosition(MontageInstance->GetPosition());
+	if (PriorSectionIndex != INDEX_NONE && PriorSectionIndex != CurrentSectionIndex)
+	{
+		const float SectionStartTime = SectionCache.GetSectionStartTime(PriorSectionIndex);
+		const float SectionEndTime = SectionStartTime + SectionCache.GetSectionLength(PriorSectionIndex);
+
+		const double WorldTime = GetWorld() ? GetWorld()->GetTimeSeconds() : PredictionWorldTime;
+		const float ElapsedPosition = (WorldTime - PredictionWorldTime) * MontageInstance->GetPlayRate();
+		const float RestoredPosition = FMath::Clamp(PriorPosition + ElapsedPosition, SectionStartTime, SectionEndTime);
+
+		// Blend out of the rejected section rather than popping
+		AnimInstance->RequestSlotGroupInertialization(PredictiveMontage->GetGroupName(), MONTAGE_SECTION_PREDICTION_REJECT_BLENDTIME);
+		AnimInstance->Montage_SetPosition(PredictiveMontage, RestoredPosition);
+		InvalidateMontageStateSnapshotForMesh(InMesh);
+	}
+}
+
+void UPlayMontageAbilitySystemComponent::AnimMontage_UpdateReplicatedDataForMesh(USkeletalMeshComponent* InMesh)
+{
+	check(IsOwnerActorAuthoritative());
+
+	// Montages played without replication, including driven montages in a replicated group, have no entry
+	if (FGameplayAbilityRepAnimMontageForMesh* RepMontageInfo = FindGameplayAbilityRepAnimMontageForMesh(InMesh))
+	{
+		AnimMontage_UpdateReplicatedDataForMesh(*RepMontageInfo);
+	}
+}
+
+void UPlayMontageAbilitySystemComponent::AnimMontage_UpdateReplicatedDataForMesh(
+	FGameplayAbilityRepAnimMontageForMesh& OutRepAnimMontageInfo)
+{
+	FMontageReplicationGather Gather;
+	if (GatherReplicatedDataForMesh(OutRepAnimMontageInfo, Gather))
+	{
+		CommitReplicatedDataForMesh(OutRepAnimMontageInfo, Gather);
+	}
+}
+
+bool UPlayMontageAbilitySystemComponent::GatherReplicatedDataForMesh(
+	const FGameplayAbilityRepAnimMontageForMesh& RepAnimMontageInfo, FMontageReplicationGather& OutGather) const
+{
+	// A mesh without a slot never played a montage
+	const int32* SlotIndex = LocalAnimMontageSlotIndices.Find(RepAnimMontageInfo.Mesh);
+	if (!SlotIndex)
+	{
+		return false;
+	}
+
+	// Computed into a local instead of refreshing the slot's snapshot, this runs on worker threads for batched components
+	const FGameplayAbilityLocalAnimMontageForMesh& AnimMontageInfo = *LocalAnimMontageInfoForMeshes[*SlotIndex];
+	FMontageStateSnapshot Snapshot;
+	ComputeMontageStateSnapshot(AnimMontageInfo, Snapshot);
+	UAnimInstance* AnimInstance = Snapshot.AnimInstance;
+	UAnimMontage* Montage = AnimMontageInfo.LocalMontageInfo.AnimMontage;
+	if (!AnimInstance || !Montage)
+	{
+		return false;
+	}
+
+	OutGather.AnimInstance = AnimInstance;
+	OutGather.Montage = Montage;
+	OutGather.bIsStopped = Snapshot.bIsStopped;
+	OutGather.Position = Snapshot.Position;
+	OutGather.PlayRate = Snapshot.PlayRate;
+	OutGather.BlendTime = Snapshot.bIsStopped ? 0.f : AnimInstance->Montage_GetBlendTime(Montage);
+
+	OutGather.SectionIndex = Snapshot.SectionIndex;
+	OutGather.NextSectionIndex = OutGather.SectionIndex != INDEX_NONE ? AnimInstance->Montage_GetNextSectionID(Montage, OutGather.SectionIndex) : INDEX_NONE;
+
+	const float RepPosition = RepAnimMontageInfo.RepMontageInfo.Position;
+	if (RepPosition == Snapshot.Position)
+	{
+		OutGather.RepSectionIndex = OutGather.SectionIndex;
+		OutGather.RepNextSectionIndex = OutGather.NextSectionIndex;
+	}
+	else
+	{
+		OutGather.RepSectionIndex = FMontageSectionCache::FindSectionIndexFromPosition(Montage, RepPosition);
+		OutGather.RepNextSectionIndex = OutGather.RepSectionIndex != INDEX_NONE ? AnimInstance->Montage_GetNextSectionID(Montage, OutGather.RepSectionIndex) : INDEX_NONE;
+	}
+
+	return true;
+}
+
+void UPlayMontageAbilitySystemComponent::CommitReplicatedDataForMesh(
+	FGameplayAbilityRepAnimMontageForMesh& OutRepAnimMontageInfo, const FMontageReplicationGather& Gather)
+{
+	const FPlayTagGameplayAbilityRepAnimMontage PrevRepMontageInfo = OutRepAnimMontageInfo.RepMontageInfo;
+
+	OutRepAnimMontageInfo.RepMontageInfo.Animation = Gather.Montage;
+
+	// Compressed Flags
+	bool bIsStopped = Gather.bIsStopped;
+
+	if (!bIsStopped)
+	{
+		const float PlayRate = Gather.PlayRate;
+		const float Position = Gather.Position;
+
+		bool bResampleTimeline = true;
+		if (bMontageDeadReckoning)
+		{
+			// Proxies extrapolate the position, only resample when that is no longer possible:
+			// a start, stop, rate change, section change or anything else that moves the position
+			const double ServerTime = GetMontageServerWorldTime();
+			const FPlayTagGameplayAbilityRepAnimMontage& RepMontageInfo = OutRepAnimMontageInfo.RepMontageInfo;
+			const float ExtrapolatedPosition = RepMontageInfo.GetDeadReckonedPosition(ServerTime);
+
+			bResampleTimeline = !RepMontageInfo.bDeadReckoning
+				|| RepMontageInfo.IsStopped
+				|| RepMontageInfo.PlayRate != PlayRate
+				|| Gather.SectionIndex != Gather.RepSectionIndex
+				|| FMath::Abs(ExtrapolatedPosition - Position) > CVarDeadReckoningMontageErrorThreshold.GetValueOnGameThread();
+
+			if (bResampleTimeline)
+			{
+				OutRepAnimMontageInfo.RepMontageInfo.PositionServerTime = ServerTime;
+			}
+		}
+		OutRepAnimMontageInfo.RepMontageInfo.bDeadReckoning = bMontageDeadReckoning;
+
+		if (bResampleTimeline)
+		{
+			OutRepAnimMontageInfo.RepMontageInfo.PlayRate = PlayRate;
+			OutRepAnimMontageInfo.RepMontageInfo.Position = Position;
+			OutRepAnimMontageInfo.RepMontageInfo.BlendTime = Gather.BlendTime;
+		}
+	}
+
+	if (OutRepAnimMontageInfo.RepMontageInfo.IsStopped != bIsStopped)
+	{
+		// Set this prior to calling UpdateShouldTick, so we start ticking if we are playing a Montage
+		OutRepAnimMontageInfo.RepMontageInfo.IsStopped = bIsStopped;
+
+		// When we start or stop an animation, update the clients right away for the Avatar Actor
+		ForceMontageNetUpdate();
+
+		// When this changes, we should update whether or not we should be ticking
+		UpdateShouldTick();
+		UpdateMontageReplicationBatchRegistration();
+	}
+
+	// Replicate NextSectionID to keep it in sync.
+	// We actually replicate NextSectionID+1 on a BYTE to put INDEX_NONE in there.
+	const bool bResampledPosition = OutRepAnimMontageInfo.RepMontageInfo.Position == Gather.Position;
+	int32 CurrentSectionID = bResampledPosition ? Gather.SectionIndex : Gather.RepSectionIndex;
+	if (CurrentSectionID != INDEX_NONE)
+	{
+		int32 NextSectionID = bResampledPosition ? Gather.NextSectionIndex : Gather.RepNextSectionIndex;
+		if (NextSectionID >= (256 - 1))
+		{
+			ABILITY_LOG(Error, TEXT("AnimMontage_UpdateReplicatedData. NextSectionID = %d.  RepAnimMontageInfo.Position: %.2f, CurrentSectionID: %d. LocalAnimMontageInfo.AnimMontage %s"),
+				NextSectionID, OutRepAnimMontageInfo.RepMontageInfo.Position, CurrentSectionID, *GetNameSafe(Gather.Montage));
+			ensure(NextSectionID < (256 - 1));
+		}
+		OutRepAnimMontageInfo.RepMontageInfo.NextSectionID = uint8(NextSectionID + 1);
+	}
+	else
+	{
+		OutRepAnimMontageInfo.RepMontageInfo.NextSectionID = 0;
+	}
+
+	if (bRecordMontageReplayEvents && IsRecordingMontageReplayEvents())
+	{
+		RecordMontageReplayEventForMesh(OutRepAnimMontageInfo.Mesh, Gather.Montage, Gather.AnimInstance);
+	}
+
+	// Only send this entry if something actually changed
+	if (OutRepAnimMontageInfo.RepMontageInfo.HasReplicatedChanges(PrevRepMontageInfo))
+	{
+		const bool bPositionRefreshOnly = !OutRepAnimMontageInfo.RepMontageInfo.HasReplicatedEventChanges(PrevRepMontageInfo);
+		RepAnimMontageInfoForMeshes.MarkEntryDirty(OutRepAnimMontageInfo, bPositionRefreshOnly);
+	}
+}
+
+void UPlayMontageAbilitySystemComponent::AnimMontage_UpdateForcedPlayFlagsForMesh(
+	FGameplayAbilityRepAnimMontageForMesh& OutRepAnimMontageInfo)
+{
+	FGameplayAbilityLocalAnimMontageForMesh& AnimMontageInfo = GetLocalAnimMontageInfoForMesh(OutRepAnimMontageInfo.Mesh);
+}
+
+void UPlayMontageAbilitySystemComponent::OnRep_ReplicatedAnimMontageForMesh()
+{
+	for (FGameplayAbilityRepAnimMontageForMesh& NewRepMontageInfoForMesh : RepAnimMontageInfoForMeshes.Items)
+	{
+		OnRep_ReplicatedAnimMontageEntry(NewRepMontageInfoForMesh);
+	}
+}
+
+void UPlayMontageAbilitySystemComponent::OnRep_ReplicatedAnimMontageEntry(
+	FGameplayAbilityRepAnimMontageForMesh& NewRepMontageInfoForMesh)
+{
+	UAnimInstance* AnimInstance = IsValid(NewRepMontageInfoForMesh.Mesh) && NewRepMontageInfoForMesh.Mesh->GetOwner()
+		== AbilityActorInfo->AvatarActor ? NewRepMontageInfoForMesh.Mesh->GetAnimInstance() : nullptr;
+
+	// Skip entries this proxy already applied, as long as the montage they describe is still what is playing
+	if (AnimInstance && NewRepMontageInfoForMesh.IsUnchangedSinceLastApplied())
+	{
+		const UAnimMontage* RepMontage = NewRepMontageInfoForMesh.RepMontageInfo.GetAnimMontage();
+		if (!RepMontage || NewRepMontageInfoForMesh.RepMontageInfo.IsStopped || AnimInstance->GetActiveInstanceForMontage(RepMontage))
+		{
+			INC_DWORD_STAT(STAT_MontageRep_SkippedEntries);
+			FPlayMontageAdvancedMetrics::Get().SkippedEntries++;
+			return;
+		}
+	}
+
+	// Cached once the entry is applied, before the play rate is overridden below
+	const FPlayTagGameplayAbilityRepAnimMontage IncomingRepMontageInfo = NewRepMontageInfoForMesh.RepMontageInfo;
+
+	FGameplayAbilityLocalAnimMontageForMesh& AnimMontageInfo = GetLocalAnimMontageInfoForMesh(NewRepMontageInfoForMesh.Mesh);
+
+	UWorld* World = GetWorld();
+
+	if (NewRepMontageInfoForMesh.RepMontageInfo.bSkipPlayRate)
+	{
+		NewRepMontageInfoForMesh.RepMontageInfo.PlayRate = 1.f;
+	}
+
+	const bool bIsPlayingReplay = World && World->IsPlayingReplay();
+
+	const float MONTAGE_REP_POS_ERR_THRESH = bIsPlayingReplay ? CVarReplayMontageErrorThreshold.GetValueOnGameThread() : 0.1f;
+
+	if (AnimInstance == nullptr || !IsReadyForReplicatedMontageForMesh())
+	{
+		// We can't handle this yet, other meshes are unaffected
+		AddPendingMontageRepForMesh(NewRepMontageInfoForMesh.Mesh);
+		return;
+	}
+	RemovePendingMontageRepForMesh(NewRepMontageInfoForMesh.Mesh);
+
+	if (!AbilityActorInfo->IsLocallyControlled())
+	{
+		static const auto CVar = IConsoleManager::Get().FindTConsoleVariableDataInt(TEXT("net.Montage.Debug"));
+		bool DebugMontage = (CVar && CVar->GetValueOnGameThread() == 1);
+		if (DebugMontage)
+		{
+			ABILITY_LOG(Warning, TEXT("\n\nOnRep_ReplicatedAnimMontage, %s"), *GetNameSafe(this));
+			ABILITY_LOG(Warning, TEXT("\tAnimMontage: %s\n\tPlayRate: %f\n\tPosition: %f\n\tBlendTime: %f\n\tNextSectionID: %d\n\tIsStopped: %d"),
+				*GetNameSafe(NewRepMontageInfoForMesh.RepMontageInfo.Animation),
+				NewRepMontageInfoForMesh.RepMontageInfo.PlayRate,
+				NewRepMontageInfoForMesh.RepMontageInfo.Position,
+				NewRepMontageInfoForMesh.RepMontageInfo.BlendTime,
+				NewRepMontageInfoForMesh.RepMontageInfo.NextSectionID,
+				NewRepMontageInfoForMesh.RepMontageInfo.IsStopped);
+			ABILITY_LOG(Warning, TEXT("\tLocalAnimMontageInfo.AnimMontage: %s\n\tPosition: %f"),
+				*GetNameSafe(AnimMontageInfo.LocalMontageInfo.AnimMontage), AnimInstance->Montage_GetPosition(AnimMontageInfo.LocalMontageInfo.AnimMontage));
+		}
+
+		if (NewRepMontageInfoForMesh.RepMontageInfo.Animation)
+		{
+			// Position the authority is at now, extrapolated if it is dead reckoning
+			const float RepPosition = GetReplicatedMontagePosition(NewRepMontageInfoForMesh.RepMontageInfo);
+
+			// New Montage to play
+			if ((AnimMontageInfo.LocalMontageInfo.AnimMontage != NewRepMontageInfoForMesh.RepMontageInfo.Animation))
+			{
+				// Start in the replicated section, shortly before the authority's position, instead of fast-forwarding from the start
+				// The position correction below then only triggers the notifies within the window
+				UAnimMontage* NewMontage = NewRepMontageInfoForMesh.RepMontageInfo.GetAnimMontage();
+				const FMontageSectionCache& SectionCache = FMontageSectionCache::Get(NewMontage);
+				const int32 JoinSectionID = SectionCache.GetSectionIndexFromPosition(RepPosition);
+				const float SectionStartTime = SectionCache.GetSectionStartTime(JoinSectionID);
+				const float StartTime = FMath::Max(SectionStartTime, RepPosition - CVarMontageJoinNotifyWindow.GetValueOnGameThread());
+				const bool bJoinInProgress = StartTime > SectionStartTime;
+
+				if (bJoinInProgress)
+				{
+					// The montage already finished, there is nothing to catch up on
+					if (NewRepMontageInfoForMesh.RepMontageInfo.IsStopped)
+					{
+						return;
 					}
 
-					// Update Position. If error is too great, jump to replicated position.
-					const float CurrentPosition = AnimInstance->Montage_GetPosition(AnimMontageInfo.LocalMontageInfo.AnimMontage);
-					const int32 CurrentSectionID = AnimMontageInfo.LocalMontageInfo.AnimMontage->GetSectionIndexFromPosition(CurrentPosition);
-					const float DeltaPosition = NewRepMontageInfoForMesh.RepMontageInfo.Position - CurrentPosition;
+					// Spread joins across frames when many actors become relevant at once
+					if (!ConsumeMontageJoinBudget(GetWorld()))
+					{
+						PendingMontageJoinMeshes.AddUnique(NewRepMontageInfoForMesh.Mesh);
+						UpdateShouldTick();
+						return;
+					}
+				}
+				PendingMontageJoinMeshes.Remove(NewRepMontageInfoForMesh.Mesh);
+
+				PlayMontageSimulatedForMesh(NewRepMontageInfoForMesh.Mesh,
+					NewMontage, NewRepMontageInfoForMesh.RepMontageInfo.PlayRate,
+					NewRepMontageInfoForMesh.RepMontageInfo.bOverrideBlendIn, NewRepMontageInfoForMesh.RepMontageInfo.BlendInOverride,
+					StartTime, NAME_None, NewRepMontageInfoForMesh.RepMontageInfo.BlendInPresetID);
+			}
+
+			if (AnimMontageInfo.LocalMontageInfo.AnimMontage == nullptr)
+			{
+				ABILITY_LOG(Warning, TEXT("OnRep_ReplicatedAnimMontage: PlayMontageSimulated failed. Name: %s, AnimMontage: %s"), *GetNameSafe(this), *GetNameSafe(NewRepMontageInfoForMesh.RepMontageInfo.GetAnimMontage()));
+				return;
+			}
 
-					// Only check threshold if we are located in the same section. Different sections require a bit more work as we could be jumping around the timeline.
-					// And therefore DeltaPosition is not as trivial to determine.
-					if ((CurrentSectionID == RepSectionID) && (FMath::Abs(DeltaPosition) > MONTAGE_REP_POS_ERR_THRESH) && (NewRepMontageInfoForMesh.RepMontageInfo.IsStopped == 0))
+			NewRepMontageInfoForMesh.SetLastApplied(IncomingRepMontageInfo);
+			INC_DWORD_STAT(STAT_MontageRep_AppliedEntries);
+			FPlayMontageAdvancedMetrics::Get().AppliedEntries++;
+
+			// The replicated state supersedes any warp in progress, a new one is started below if the error remains
+			StopMontagePositionWarpForMesh(NewRepMontageInfoForMesh.Mesh);
+
+			// Play Rate has changed
+			if (AnimInstance->Montage_GetPlayRate(AnimMontageInfo.LocalMontageInfo.AnimMontage) != NewRepMontageInfoForMesh.RepMontageInfo.PlayRate)
+			{
+				AnimInstance->Montage_SetPlayRate(AnimMontageInfo.LocalMontageInfo.AnimMontage, NewRepMontageInfoForMesh.RepMontageInfo.PlayRate);
+				InvalidateMontageStateSnapshotForMesh(NewRepMontageInfoForMesh.Mesh);
+			}
+
+			// Compressed Flags
+			const bool bIsStopped = AnimInstance->Montage_GetIsStopped(AnimMontageInfo.LocalMontageInfo.AnimMontage);
+			const bool bReplicatedIsStopped = bool(NewRepMontageInfoForMesh.RepMontageInfo.IsStopped);
+
+			// Process stopping first, so we don't change sections and cause blending to pop.
+			if (bReplicatedIsStopped)
+			{
+				if (!bIsStopped)
+				{
+					CurrentMontageStopForMesh(NewRepMontageInfoForMesh.Mesh, NewRepMontageInfoForMesh.RepMontageInfo.BlendTime);
+				}
+			}
+			else if (!NewRepMontageInfoForMesh.RepMontageInfo.SkipPositionCorrection)
+			{
+				const FMontageSectionCache& SectionCache = FMontageSectionCache::Get(AnimMontageInfo.LocalMontageInfo.AnimMontage);
+				const int32 RepSectionID = SectionCache.GetSectionIndexFromPosition(NewRepMontageInfoForMesh.RepMontageInfo.Position);
+				const int32 RepNextSectionID = int32(NewRepMontageInfoForMesh.RepMontageInfo.NextSectionID) - 1;
+
+				// And NextSectionID for the replicated SectionID.
+				if (RepSectionID != INDEX_NONE)
+				{
+					const int32 NextSectionID = AnimInstance->Montage_GetNextSectionID(AnimMontageInfo.LocalMontageInfo.AnimMontage, RepSectionID);
+
+					// If NextSectionID is different from the replicated one, then set it.
+					if (NextSectionID != RepNextSectionID)
+					{
+						AnimInstance->Montage_SetNextSection(SectionCache.GetSectionName(RepSectionID), SectionCache.GetSectionName(RepNextSectionID), AnimMontageInfo.LocalMontageInfo.AnimMontage);
+					}
+
+					// Make sure we haven't received that update too late and the client hasn't already jumped to another section. 
+					const int32 CurrentSectionID = SectionCache.GetSectionIndexFromPosition(AnimInstance->Montage_GetPosition(AnimMontageInfo.LocalMontageInfo.AnimMontage));
+					if ((CurrentSectionID != RepSectionID) && (CurrentSectionID != RepNextSectionID))
+					{
+						// Client is in a wrong section, teleport him into the begining of the right section
+						const float SectionStartTime = SectionCache.GetSectionStartTime(RepSectionID);
+						AnimInstance->Montage_SetPosition(AnimMontageInfo.LocalMontageInfo.AnimMontage, SectionStartTime);
+						InvalidateMontageStateSnapshotForMesh(NewRepMontageInfoForMesh.Mesh);
+					}
+				}
+
+				// Update Position. If error is too great, jump to replicated position.
+				const float CurrentPosition = AnimInstance->Montage_GetPosition(AnimMontageInfo.LocalMontageInfo.AnimMontage);
+				const int32 CurrentSectionID = SectionCache.GetSectionIndexFromPosition(CurrentPosition);
+				const float DeltaPosition = RepPosition - CurrentPosition;
+
+				// Only check threshold if we are located in the same section. Different sections require a bit more work as we could be jumping around the timeline.
+				// And therefore DeltaPosition is not as trivial to determine.
+				if ((CurrentSectionID == RepSectionID) && (FMath::Abs(DeltaPosition) > MONTAGE_REP_POS_ERR_THRESH) && (NewRepMontageInfoForMesh.RepMontageInfo.IsStopped == 0))
+				{
+					// Small and medium errors are absorbed over time rather than popping, replays scrub and always snap
+					if (bMontagePositionWarping && !bIsPlayingReplay && FMath::Abs(DeltaPosition) <= MontagePositionWarpMaxError &&
+						StartMontagePositionWarpForMesh(NewRepMontageInfoForMesh.Mesh, AnimMontageInfo.LocalMontageInfo.AnimMontage, AnimInstance, DeltaPosition))
 					{
+						INC_DWORD_STAT(STAT_MontageRep_PositionWarps);
+						FPlayMontageAdvancedMetrics::Get().PositionWarps++;
+					}
+					else
+					{
+						INC_DWORD_STAT(STAT_MontageRep_PositionSnaps);
+						FPlayMontageAdvancedMetrics::Get().PositionSnaps++;
+
 						// fast-forward to server position and trigger notifies
 						if (FAnimMontageInstance* MontageInstance = AnimInstance->GetActiveInstanceForMontage(NewRepMontageInfoForMesh.RepMontageInfo.GetAnimMontage()))
 						{
@@ -672,93 +1889,627 @@ void UPlayMontageAbilitySystemComponent::OnRep_ReplicatedAnimMontageForMesh()
 							if (DeltaTime >= 0.f)
 							{
 								MontageInstance->UpdateWeight(DeltaTime);
-								MontageInstance->HandleEvents(CurrentPosition, NewRepMontageInfoForMesh.RepMontageInfo.Position, nullptr);
+								MontageInstance->HandleEvents(CurrentPosition, RepPosition, nullptr);
 								AnimInstance->TriggerAnimNotifies(DeltaTime);
 							}
 						}
-						AnimInstance->Montage_SetPosition(AnimMontageInfo.LocalMontageInfo.AnimMontage, NewRepMontageInfoForMesh.RepMontageInfo.Position);
+						AnimInstance->Montage_SetPosition(AnimMontageInfo.LocalMontageInfo.AnimMontage, RepPosition);
+						InvalidateMontageStateSnapshotForMesh(NewRepMontageInfoForMesh.Mesh);
 					}
 				}
 			}
+
+			// Driven montages follow the driver
+			OnRep_DrivenMontagesForMesh(NewRepMontageInfoForMesh, RepPosition, MONTAGE_REP_POS_ERR_THRESH);
 		}
 	}
 }
 
-bool UPlayMontageAbilitySystemComponent::IsReadyForReplicatedMontageForMesh()
+void UPlayMontageAbilitySystemComponent::OnRep_RemovedAnimMontageEntry(
+	const FGameplayAbilityRepAnimMontageForMesh& OldRepMontageInfoForMesh)
 {
-	/** Children may want to override this for additional checks (e.g, "has skin been applied") */
-	return true;
+	RemovePendingMontageRepForMesh(OldRepMontageInfoForMesh.Mesh);
+
+	// The server no longer replicates this mesh, stop the montage it was driving
+	const UAnimMontage* OldMontage = OldRepMontageInfoForMesh.RepMontageInfo.GetAnimMontage();
+	if (OldMontage && AbilityActorInfo.IsValid() && !AbilityActorInfo->IsLocallyControlled())
+	{
+		StopMontageIfCurrentForMesh(OldRepMontageInfoForMesh.Mesh, *OldMontage, OldRepMontageInfoForMesh.RepMontageInfo.BlendTime);
+
+		FGameplayAbilityLocalAnimMontageForMesh* AnimMontageInfo = FindLocalAnimMontageInfoForMesh(OldRepMontageInfoForMesh.Mesh);
+		const TArray<FDrivenMontagePair> SimulatedDrivenMontages = AnimMontageInfo ? MoveTemp(AnimMontageInfo->SimulatedDrivenMontages) : TArray<FDrivenMontagePair>();
+		for (const FDrivenMontagePair& Driven : SimulatedDrivenMontages)
+		{
+			if (Driven.Montage)
+			{
+				StopMontageIfCurrentForMesh(Driven.Mesh, *Driven.Montage, OldRepMontageInfoForMesh.RepMontageInfo.BlendTime);
+			}
+		}
+	}
 }
 
-void UPlayMontageAbilitySystemComponent::ServerCurrentMontageSetNextSectionNameForMesh_Implementation(
-	USkeletalMeshComponent* InMesh, UAnimMontage* ClientAnimMontage, float ClientPosition, FName SectionName,
-	FName NextSectionName)
+void UPlayMontageAbilitySystemComponent::OnRep_DrivenMontagesForMesh(
+	const FGameplayAbilityRepAnimMontageForMesh& DriverRepMontageInfoForMesh, float DriverPosition, float PositionErrorThreshold)
 {
-	UAnimInstance* AnimInstance = IsValid(InMesh) && InMesh->GetOwner() == AbilityActorInfo->AvatarActor ? InMesh->GetAnimInstance() : nullptr;
-	FGameplayAbilityLocalAnimMontageForMesh& AnimMontageInfo = GetLocalAnimMontageInfoForMesh(InMesh);
+	const FPlayTagGameplayAbilityRepAnimMontage& DriverRepMontageInfo = DriverRepMontageInfoForMesh.RepMontageInfo;
+	const UAnimMontage* DriverMontage = DriverRepMontageInfo.GetAnimMontage();
+	const float DriverDuration = DriverMontage ? DriverMontage->GetPlayLength() : 0.f;
 
-	if (AnimInstance)
+	// Stop driven montages that are no longer part of the group
 	{
-		UAnimMontage* CurrentAnimMontage = AnimMontageInfo.LocalMontageInfo.AnimMontage;
-		if (ClientAnimMontage == CurrentAnimMontage)
+		FGameplayAbilityLocalAnimMontageForMesh& DriverMontageInfo = GetLocalAnimMontageInfoForMesh(DriverRepMontageInfoForMesh.Mesh);
+		const TArray<FDrivenMontagePair> PrevDrivenMontages = MoveTemp(DriverMontageInfo.SimulatedDrivenMontages);
+		DriverMontageInfo.SimulatedDrivenMontages = DriverRepMontageInfoForMesh.DrivenMontages;
+		for (const FDrivenMontagePair& PrevDriven : PrevDrivenMontages)
 		{
-			// Set NextSectionName
-			AnimInstance->Montage_SetNextSection(SectionName, NextSectionName, CurrentAnimMontage);
+			const bool bStillDriven = DriverRepMontageInfoForMesh.DrivenMontages.ContainsByPredicate([&PrevDriven](const FDrivenMontagePair& Driven)
+			{
+				return Driven.Mesh == PrevDriven.Mesh && Driven.Montage == PrevDriven.Montage;
+			});
+			if (!bStillDriven && PrevDriven.Montage)
+			{
+				StopMontageIfCurrentForMesh(PrevDriven.Mesh, *PrevDriven.Montage, DriverRepMontageInfo.BlendTime);
+			}
+		}
+	}
 
-			// Correct position if we are in an invalid section
-			float CurrentPosition = AnimInstance->Montage_GetPosition(CurrentAnimMontage);
-			int32 CurrentSectionID = CurrentAnimMontage->GetSectionIndexFromPosition(CurrentPosition);
-			FName CurrentSectionName = CurrentAnimMontage->GetSectionName(CurrentSectionID);
+	for (const FDrivenMontagePair& Driven : DriverRepMontageInfoForMesh.DrivenMontages)
+	{
+		UAnimInstance* AnimInstance = Driven.Montage && IsValid(Driven.Mesh) && Driven.Mesh->GetOwner() == AbilityActorInfo->AvatarActor ?
+			Driven.Mesh->GetAnimInstance() : nullptr;
+		if (!AnimInstance)
+		{
+			continue;
+		}
 
-			int32 ClientSectionID = CurrentAnimMontage->GetSectionIndexFromPosition(ClientPosition);
-			FName ClientCurrentSectionName = CurrentAnimMontage->GetSectionName(ClientSectionID);
-			if ((CurrentSectionName != ClientCurrentSectionName) || (CurrentSectionName != SectionName))
+		// Same derivation the authority used when it played the group, see UAbilityTask_PlayMontageAdvanced::PlayDrivenMontageForMesh
+		const float Scale = DriverRepMontageInfoForMesh.bDrivenMontagesMatchDriverDuration ?
+			UPlayMontageAdvancedLib::GetMontagePlayRateScaledByDuration(Driven.Montage, DriverDuration) : 1.f;
+		const float DrivenPlayRate = DriverRepMontageInfo.PlayRate * Scale;
+		const float DrivenPosition = FMath::Clamp(DriverPosition * Scale, 0.f, Driven.Montage->GetPlayLength());
+
+		FGameplayAbilityLocalAnimMontageForMesh& AnimMontageInfo = GetLocalAnimMontageInfoForMesh(Driven.Mesh);
+		if (AnimMontageInfo.LocalMontageInfo.AnimMontage != Driven.Montage)
+		{
+			if (DriverRepMontageInfo.IsStopped)
 			{
-				// We are in an invalid section, jump to client's position.
-				AnimInstance->Montage_SetPosition(CurrentAnimMontage, ClientPosition);
+				continue;
 			}
 
-			// Update replicated version for Simulated Proxies if we are on the server.
-			if (IsOwnerActorAuthoritative())
+			PlayMontageSimulatedForMesh(Driven.Mesh, Driven.Montage, DrivenPlayRate,
+				DriverRepMontageInfo.bOverrideBlendIn, DriverRepMontageInfo.BlendInOverride,
+				DrivenPosition, NAME_None, DriverRepMontageInfo.BlendInPresetID);
+			continue;
+		}
+
+		if (DriverRepMontageInfo.IsStopped)
+		{
+			if (!AnimInstance->Montage_GetIsStopped(Driven.Montage))
 			{
-				AnimMontage_UpdateReplicatedDataForMesh(InMesh);
+				CurrentMontageStopForMesh(Driven.Mesh, DriverRepMontageInfo.BlendTime);
+			}
+			continue;
+		}
+
+		if (AnimInstance->Montage_GetPlayRate(Driven.Montage) != DrivenPlayRate)
+		{
+			AnimInstance->Montage_SetPlayRate(Driven.Montage, DrivenPlayRate);
+			InvalidateMontageStateSnapshotForMesh(Driven.Mesh);
+		}
+
+		if (!DriverRepMontageInfo.SkipPositionCorrection)
+		{
+			const float CurrentPosition = AnimInstance->Montage_GetPosition(Driven.Montage);
+			if (FMath::Abs(DrivenPosition - CurrentPosition) > PositionErrorThreshold * Scale)
+			{
+				AnimInstance->Montage_SetPosition(Driven.Montage, DrivenPosition);
+				InvalidateMontageStateSnapshotForMesh(Driven.Mesh);
 			}
 		}
 	}
 }
 
-bool UPlayMontageAbilitySystemComponent::ServerCurrentMontageSetNextSectionNameForMesh_Validate(
-	USkeletalMeshComponent* InMesh, UAnimMontage* ClientAnimMontage, float ClientPosition, FName SectionName,
-	FName NextSectionName)
+double UPlayMontageAbilitySystemComponent::GetMontageServerWorldTime() const
 {
+	const UWorld* World = GetWorld();
+	if (const AGameStateBase* GameState = World ? World->GetGameState() : nullptr)
+	{
+		return GameState->GetServerWorldTimeSeconds();
+	}
+	return World ? World->GetTimeSeconds() : 0.0;
+}
+
+float UPlayMontageAbilitySystemComponent::GetReplicatedMontagePosition(const FPlayTagGameplayAbilityRepAnimMontage& RepMontageInfo) const
+{
+	const UAnimMontage* Montage = RepMontageInfo.GetAnimMontage();
+	if (!RepMontageInfo.bDeadReckoning || RepMontageInfo.IsStopped || !Montage)
+	{
+		return RepMontageInfo.Position;
+	}
+
+	// Only extrapolate within the replicated section, the replicated NextSectionID takes over from there
+	const float ExtrapolatedPosition = FMath::Clamp(RepMontageInfo.GetDeadReckonedPosition(GetMontageServerWorldTime()), 0.f, Montage->GetPlayLength());
+	const FMontageSectionCache& SectionCache = FMontageSectionCache::Get(Montage);
+	if (SectionCache.GetSectionIndexFromPosition(ExtrapolatedPosition) != SectionCache.GetSectionIndexFromPosition(RepMontageInfo.Position))
+	{
+		return RepMontageInfo.Position;
+	}
+	return ExtrapolatedPosition;
+}
+
+bool UPlayMontageAbilitySystemComponent::StartMontagePositionWarpForMesh(USkeletalMeshComponent* InMesh,
+	UAnimMontage* Montage, UAnimInstance* AnimInstance, float DeltaPosition)
+{
+	const float BasePlayRate = AnimInstance->Montage_GetPlayRate(Montage);
+	const float WarpedPlayRate = BasePlayRate + DeltaPosition / FMath::Max(MontagePositionWarpDuration, UE_KINDA_SMALL_NUMBER);
+
+	// A paused montage can't be warped, and warping past zero would replay notifies that were already triggered
+	if (WarpedPlayRate * BasePlayRate <= 0.f)
+	{
+		return false;
+	}
+
+	FMontagePositionWarpForMesh& Warp = MontagePositionWarps.AddDefaulted_GetRef();
+	Warp.Mesh = InMesh;
+	Warp.Montage = Montage;
+	Warp.BasePlayRate = BasePlayRate;
+	Warp.TimeRemaining = MontagePositionWarpDuration;
+
+	AnimInstance->Montage_SetPlayRate(Montage, WarpedPlayRate);
+	InvalidateMontageStateSnapshotForMesh(InMesh);
+	UpdateShouldTick();
 	return true;
 }
 
-void UPlayMontageAbilitySystemComponent::ServerCurrentMontageJumpToSectionNameForMesh_Implementation(
-	USkeletalMeshComponent* InMesh, UAnimMontage* ClientAnimMontage, FName SectionName)
+void UPlayMontageAbilitySystemComponent::StopMontagePositionWarpForMesh(USkeletalMeshComponent* InMesh)
 {
+	const int32 WarpIndex = MontagePositionWarps.IndexOfByPredicate([InMesh](const FMontagePositionWarpForMesh& Warp)
+	{
+		return Warp.Mesh == InMesh;
+	});
+	if (WarpIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	const FMontagePositionWarpForMesh Warp = MontagePositionWarps[WarpIndex];
+	MontagePositionWarps.RemoveAtSwap(WarpIndex);
+
+	// Only restore the play rate if the warped montage is still playing
 	UAnimInstance* AnimInstance = IsValid(InMesh) && InMesh->GetOwner() == AbilityActorInfo->AvatarActor ? InMesh->GetAnimInstance() : nullptr;
-	FGameplayAbilityLocalAnimMontageForMesh& AnimMontageInfo = GetLocalAnimMontageInfoForMesh(InMesh);
+	if (AnimInstance && Warp.Montage && AnimInstance->GetActiveInstanceForMontage(Warp.Montage))
+	{
+		AnimInstance->Montage_SetPlayRate(Warp.Montage, Warp.BasePlayRate);
+		InvalidateMontageStateSnapshotForMesh(InMesh);
+	}
+}
 
-	if (AnimInstance)
+void UPlayMontageAbilitySystemComponent::UpdateMontagePositionWarps(float DeltaTime)
+{
+	if (MontagePositionWarps.Num() == 0)
 	{
-		UAnimMontage* CurrentAnimMontage = AnimMontageInfo.LocalMontageInfo.AnimMontage;
-		if (ClientAnimMontage == CurrentAnimMontage)
+		return;
+	}
+
+	// Iterate backwards, completed warps are removed with a swap
+	for (int32 WarpIndex = MontagePositionWarps.Num() - 1; WarpIndex >= 0; WarpIndex--)
+	{
+		FMontagePositionWarpForMesh& Warp = MontagePositionWarps[WarpIndex];
+		Warp.TimeRemaining -= DeltaTime;
+		if (Warp.TimeRemaining <= 0.f)
 		{
-			// Set NextSectionName
-			AnimInstance->Montage_JumpToSection(SectionName, CurrentAnimMontage);
+			StopMontagePositionWarpForMesh(Warp.Mesh);
+		}
+	}
 
-			// Update replicated version for Simulated Proxies if we are on the server.
-			if (IsOwnerActorAuthoritative())
+	// Stop ticking if the warps were all that kept us ticking
+	if (MontagePositionWarps.Num() == 0)
+	{
+		UpdateShouldTick();
+	}
+}
+
+const FMontageReplicationLODTier* UPlayMontageAbilitySystemComponent::GetMontageReplicationLODTier(const UNetConnection* Connection) const
+{
+	const UPlayMontageAdvancedSettings* Settings = GetDefault<UPlayMontageAdvancedSettings>();
+	if (!Settings->bEnableMontageReplicationLOD || !Connection || Connection->IsReplay())
+	{
+		return nullptr;
+	}
+
+	// The owning connection predicts montages and needs every correction
+	const AActor* OwnerActor = GetOwner();
+	const AActor* AvatarActor = GetAvatarActor_Direct();
+	const AActor* ViewTarget = Connection->ViewTarget;
+	if (!OwnerActor || !AvatarActor || !ViewTarget || OwnerActor->GetNetConnection() == Connection)
+	{
+		return nullptr;
+	}
+
+	// Higher net priority pulls the avatar into a nearer tier
+	const float NetPriority = FMath::Max(OwnerActor->NetPriority, UE_KINDA_SMALL_NUMBER);
+	const float Distance = FVector::Dist(ViewTarget->GetActorLocation(), AvatarActor->GetActorLocation()) / NetPriority;
+	return Settings->GetMontageReplicationLODTier(Distance);
+}
+
+FMontageControlForMesh& UPlayMontageAbilitySystemComponent::GetPendingMontageControlForMesh(
+	USkeletalMeshComponent* InMesh, UAnimMontage* Montage)
+{
+	FMontageControlForMesh* Control = PendingMontageControls.FindByPredicate([InMesh](const FMontageControlForMesh& Pending)
+	{
+		return Pending.Mesh == InMesh;
+	});
+
+	// State buffered for a previous montage no longer applies
+	if (!Control || Control->Montage != Montage)
+	{
+		if (!Control)
+		{
+			Control = &PendingMontageControls.AddDefaulted_GetRef();
+
+			// Start ticking so the buffered state gets flushed
+			if (PendingMontageControls.Num() == 1)
 			{
-				AnimMontage_UpdateReplicatedDataForMesh(InMesh);
+				UpdateShouldTick();
 			}
 		}
+		*Control = FMontageControlForMesh();
+		Control->Mesh = InMesh;
+		Control->Montage = Montage;
+	}
+
+	Control->RemainingSends = (uint8)FMath::Clamp(1 + CVarMontageControlResends.GetValueOnGameThread(), 1, (int32)MAX_uint8);
+	return *Control;
+}
+
+void UPlayMontageAbilitySystemComponent::FlushPendingMontageControls()
+{
+	if (PendingMontageControls.Num() == 0)
+	{
+		return;
+	}
+
+	// Coalesce changes into at most one RPC per net update of the owner
+	const UWorld* World = GetWorld();
+	const AActor* Owner = GetOwner();
+	if (World && Owner && Owner->NetUpdateFrequency > 0.f)
+	{
+		const double TimeSeconds = World->GetTimeSeconds();
+		if (TimeSeconds - LastMontageControlFlushTime < 1.0 / Owner->NetUpdateFrequency)
+		{
+			return;
+		}
+		LastMontageControlFlushTime = TimeSeconds;
+	}
+
+	for (FMontageControlForMesh& Control : PendingMontageControls)
+	{
+		Control.RemainingSends--;
+	}
+
+	ServerUpdateMontageControlsForMesh(PendingMontageControls, ++MontageControlSequence);
+	FPlayMontageAdvancedMetrics::Get().RPCs++;
+
+	PendingMontageControls.RemoveAllSwap([](const FMontageControlForMesh& Control)
+	{
+		return Control.RemainingSends == 0;
+	});
+
+	if (PendingMontageControls.Num() == 0)
+	{
+		UpdateShouldTick();
+	}
+}
+
+bool UPlayMontageAbilitySystemComponent::IsRecordingMontageReplayEvents() const
+{
+	const UWorld* World = GetWorld();
+	const UDemoNetDriver* DemoNetDriver = World ? World->GetDemoNetDriver() : nullptr;
+	return DemoNetDriver && DemoNetDriver->IsRecording();
+}
+
+void UPlayMontageAbilitySystemComponent::RecordMontageReplayEventForMesh(USkeletalMeshComponent* InMesh,
+	UAnimMontage* Montage, UAnimInstance* AnimInstance)
+{
+	FMontageReplayEventForMesh* LastEvent = MontageReplayEvents.FindByPredicate([InMesh](const FMontageReplayEventForMesh& ReplayEvent)
+	{
+		return ReplayEvent.Mesh == InMesh;
+	});
+
+	const double ServerTime = GetMontageServerWorldTime();
+	const bool bIsStopped = AnimInstance->Montage_GetIsStopped(Montage);
+	const float Position = AnimInstance->Montage_GetPosition(Montage);
+	const float PlayRate = AnimInstance->Montage_GetPlayRate(Montage);
+	const FMontageSectionCache& SectionCache = FMontageSectionCache::Get(Montage);
+	const int32 SectionID = SectionCache.GetSectionIndexFromPosition(Position);
+	const uint8 NextSectionID = SectionID != INDEX_NONE ? uint8(AnimInstance->Montage_GetNextSectionID(Montage, SectionID) + 1) : 0;
+
+	EMontageReplayEventType EventType;
+	if (!LastEvent || LastEvent->Montage != Montage || (LastEvent->bIsStopped && !bIsStopped))
+	{
+		EventType = EMontageReplayEventType::Play;
+	}
+	else if (bIsStopped)
+	{
+		if (LastEvent->bIsStopped)
+		{
+			return;
+		}
+		EventType = EMontageReplayEventType::Stop;
+	}
+	else if (SectionID != SectionCache.GetSectionIndexFromPosition(LastEvent->Position) || NextSectionID != LastEvent->NextSectionID)
+	{
+		EventType = EMontageReplayEventType::Section;
+	}
+	else if (PlayRate != LastEvent->PlayRate)
+	{
+		EventType = EMontageReplayEventType::PlayRate;
+	}
+	else
+	{
+		// Anything else that moved the position, e.g. a correction from the owning client
+		const float ExtrapolatedPosition = LastEvent->Position + (float)(ServerTime - LastEvent->ServerTime) * LastEvent->PlayRate;
+		if (FMath::Abs(ExtrapolatedPosition - Position) <= CVarReplayMontageErrorThreshold.GetValueOnGameThread())
+		{
+			return;
+		}
+		EventType = EMontageReplayEventType::Position;
+	}
+
+	if (!LastEvent)
+	{
+		LastEvent = &MontageReplayEvents.AddDefaulted_GetRef();
+		LastEvent->Mesh = InMesh;
+	}
+	LastEvent->Montage = Montage;
+	LastEvent->EventType = EventType;
+	LastEvent->ServerTime = ServerTime;
+	LastEvent->Position = Position;
+	LastEvent->PlayRate = PlayRate;
+	LastEvent->BlendTime = AnimInstance->Montage_GetBlendTime(Montage);
+	LastEvent->NextSectionID = NextSectionID;
+	LastEvent->bIsStopped = bIsStopped;
+	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, MontageReplayEvents, this);
+}
+
+void UPlayMontageAbilitySystemComponent::OnRep_MontageReplayEvents()
+{
+	for (const FMontageReplayEventForMesh& ReplayEvent : MontageReplayEvents)
+	{
+		ApplyMontageReplayEvent(ReplayEvent);
+	}
+}
+
+void UPlayMontageAbilitySystemComponent::ApplyMontageReplayEvent(const FMontageReplayEventForMesh& ReplayEvent)
+{
+	UAnimMontage* Montage = ReplayEvent.Montage;
+	UAnimInstance* AnimInstance = Montage && IsValid(ReplayEvent.Mesh) && ReplayEvent.Mesh->GetOwner() == AbilityActorInfo->AvatarActor ?
+		ReplayEvent.Mesh->GetAnimInstance() : nullptr;
+	if (!AnimInstance)
+	{
+		return;
+	}
+
+	FGameplayAbilityLocalAnimMontageForMesh& AnimMontageInfo = GetLocalAnimMontageInfoForMesh(ReplayEvent.Mesh);
+	const bool bIsPlaying = AnimMontageInfo.LocalMontageInfo.AnimMontage == Montage && !AnimInstance->Montage_GetIsStopped(Montage);
+	if (ReplayEvent.bIsStopped)
+	{
+		if (bIsPlaying)
+		{
+			CurrentMontageStopForMesh(ReplayEvent.Mesh, ReplayEvent.BlendTime);
+		}
+		return;
+	}
+
+	// Evaluate the event at the current replay time, within the section it was recorded in
+	// Natural section changes are recorded as their own events
+	const FMontageSectionCache& SectionCache = FMontageSectionCache::Get(Montage);
+	const int32 SectionID = SectionCache.GetSectionIndexFromPosition(ReplayEvent.Position);
+	float Position = ReplayEvent.Position + (float)(GetMontageServerWorldTime() - ReplayEvent.ServerTime) * ReplayEvent.PlayRate;
+	if (SectionID != INDEX_NONE)
+	{
+		const float SectionStartTime = SectionCache.GetSectionStartTime(SectionID);
+		Position = FMath::Clamp(Position, SectionStartTime, SectionStartTime + SectionCache.GetSectionLength(SectionID));
+	}
+
+	// Seek directly, notifies in between are not fast-forwarded so scrubbing stays cheap
+	if (!bIsPlaying)
+	{
+		PlayMontageSimulatedForMesh(ReplayEvent.Mesh, Montage, ReplayEvent.PlayRate, false, FMontageBlendSettings(), Position);
+	}
+	else
+	{
+		if (AnimInstance->Montage_GetPlayRate(Montage) != ReplayEvent.PlayRate)
+		{
+			AnimInstance->Montage_SetPlayRate(Montage, ReplayEvent.PlayRate);
+			InvalidateMontageStateSnapshotForMesh(ReplayEvent.Mesh);
+		}
+		if (FMath::Abs(AnimInstance->Montage_GetPosition(Montage) - Position) > CVarReplayMontageErrorThreshold.GetValueOnGameThread())
+		{
+			AnimInstance->Montage_SetPosition(Montage, Position);
+			InvalidateMontageStateSnapshotForMesh(ReplayEvent.Mesh);
+		}
+	}
+
+	const int32 NextSectionID = int32(ReplayEvent.NextSectionID) - 1;
+	if (SectionID != INDEX_NONE && AnimInstance->Montage_GetNextSectionID(Montage, SectionID) != NextSectionID)
+	{
+		AnimInstance->Montage_SetNextSection(SectionCache.GetSectionName(SectionID), SectionCache.GetSectionName(NextSectionID), Montage);
+	}
+}
+
+void UPlayMontageAbilitySystemComponent::NotifyReadyForReplicatedMontage()
+{
+	ApplyPendingMontageRepForMeshes();
+}
+
+void UPlayMontageAbilitySystemComponent::AddPendingMontageRepForMesh(USkeletalMeshComponent* InMesh)
+{
+	PendingMontageRepMeshes.AddUnique(InMesh);
+	bPendingMontageRep = true;
+
+	if (IsValid(InMesh))
+	{
+		InMesh->OnAnimInitialized.AddUniqueDynamic(this, &ThisClass::OnPendingMontageRepMeshAnimInitialized);
+	}
+}
+
+void UPlayMontageAbilitySystemComponent::RemovePendingMontageRepForMesh(USkeletalMeshComponent* InMesh)
+{
+	if (PendingMontageRepMeshes.Remove(InMesh) > 0 && IsValid(InMesh))
+	{
+		InMesh->OnAnimInitialized.RemoveDynamic(this, &ThisClass::OnPendingMontageRepMeshAnimInitialized);
+	}
+	bPendingMontageRep = PendingMontageRepMeshes.Num() > 0;
+}
+
+void UPlayMontageAbilitySystemComponent::ApplyPendingMontageRepForMeshes()
+{
+	// Copied as applying an entry removes it from the pending meshes, or adds it back if it still isn't ready
+	const TArray<USkeletalMeshComponent*> PendingMeshes = PendingMontageRepMeshes;
+	for (USkeletalMeshComponent* PendingMesh : PendingMeshes)
+	{
+		if (FGameplayAbilityRepAnimMontageForMesh* RepMontageInfo = FindGameplayAbilityRepAnimMontageForMesh(PendingMesh))
+		{
+			OnRep_ReplicatedAnimMontageEntry(*RepMontageInfo);
+		}
+		else
+		{
+			RemovePendingMontageRepForMesh(PendingMesh);
+		}
+	}
+}
+
+void UPlayMontageAbilitySystemComponent::OnPendingMontageRepMeshAnimInitialized()
+{
+	// The delegate doesn't say which mesh initialized, meshes that are still not ready stay pending
+	ApplyPendingMontageRepForMeshes();
+}
+
+void UPlayMontageAbilitySystemComponent::ProcessPendingMontageJoins()
+{
+	if (PendingMontageJoinMeshes.Num() == 0)
+	{
+		return;
+	}
+
+	// Entries that still don't fit in this frame's budget add themselves back
+	const TArray<USkeletalMeshComponent*> JoinMeshes = MoveTemp(PendingMontageJoinMeshes);
+	for (USkeletalMeshComponent* JoinMesh : JoinMeshes)
+	{
+		if (FGameplayAbilityRepAnimMontageForMesh* RepMontageInfo = FindGameplayAbilityRepAnimMontageForMesh(JoinMesh))
+		{
+			OnRep_ReplicatedAnimMontageEntry(*RepMontageInfo);
+		}
+	}
+}
+
+bool UPlayMontageAbilitySystemComponent::IsReadyForReplicatedMontageForMesh()
+{
+	/** Children may want to override this for additional checks (e.g, "has skin been applied") */
+	return true;
+}
+
+bool UPlayMontageAbilitySystemComponent::CanApplyClientMontageSectionChangeForMesh(USkeletalMeshComponent* InMesh,
+	UAnimMontage* ClientAnimMontage)
+{
+	UAnimInstance* AnimInstance = IsValid(InMesh) && InMesh->GetOwner() == AbilityActorInfo->AvatarActor ? InMesh->GetAnimInstance() : nullptr;
+	if (!AnimInstance || !ClientAnimMontage)
+	{
+		return false;
+	}
+
+	return ClientAnimMontage == FindLocalMontageForMesh(InMesh);
+}
+
+void UPlayMontageAbilitySystemComponent::RejectMontageSectionPrediction(const FPredictionKey& PredictionKey)
+{
+	if (PredictionKey.IsValidKey())
+	{
+		ClientMontageSectionPredictionRejected(PredictionKey.Current);
+		FPlayMontageAdvancedMetrics::Get().RPCs++;
+	}
+}
+
+void UPlayMontageAbilitySystemComponent::ClientMontageSectionPredictionRejected_Implementation(int16 PredictionKeyId)
+{
+	FPlayMontageAdvancedMetrics::Get().SectionPredictionRejections++;
+	FPredictionKeyDelegates::BroadcastRejectedDelegate(PredictionKeyId);
+}
+
+void UPlayMontageAbilitySystemComponent::ServerCurrentMontageSetNextSectionNameForMesh_Implementation(
+	USkeletalMeshComponent* InMesh, UAnimMontage* ClientAnimMontage, float ClientPosition, FName SectionName,
+	FName NextSectionName, FPredictionKey PredictionKey)
+{
+	// Accepting the change needs no reply, the key is acknowledged when the window closes
+	FScopedPredictionWindow ScopedPrediction(this, PredictionKey);
+
+	if (!CanApplyClientMontageSectionChangeForMesh(InMesh, ClientAnimMontage))
+	{
+		RejectMontageSectionPrediction(PredictionKey);
+		return;
+	}
+
+	UAnimInstance* AnimInstance = InMesh->GetAnimInstance();
+	UAnimMontage* CurrentAnimMontage = ClientAnimMontage;
+
+	// Set NextSectionName
+	AnimInstance->Montage_SetNextSection(SectionName, NextSectionName, CurrentAnimMontage);
+
+	// Correct position if we are in an invalid section
+	float CurrentPosition = AnimInstance->Montage_GetPosition(CurrentAnimMontage);
+	const FMontageSectionCache& SectionCache = FMontageSectionCache::Get(CurrentAnimMontage);
+	int32 CurrentSectionID = SectionCache.GetSectionIndexFromPosition(CurrentPosition);
+	FName CurrentSectionName = SectionCache.GetSectionName(CurrentSectionID);
+
+	int32 ClientSectionID = SectionCache.GetSectionIndexFromPosition(ClientPosition);
+	FName ClientCurrentSectionName = SectionCache.GetSectionName(ClientSectionID);
+	if ((CurrentSectionName != ClientCurrentSectionName) || (CurrentSectionName != SectionName))
+	{
+		// We are in an invalid section, jump to client's position.
+		AnimInstance->Montage_SetPosition(CurrentAnimMontage, ClientPosition);
+		InvalidateMontageStateSnapshotForMesh(InMesh);
+	}
+
+	// Update replicated version for Simulated Proxies if we are on the server.
+	if (IsOwnerActorAuthoritative())
+	{
+		AnimMontage_UpdateReplicatedDataForMesh(InMesh);
+	}
+}
+
+bool UPlayMontageAbilitySystemComponent::ServerCurrentMontageSetNextSectionNameForMesh_Validate(
+	USkeletalMeshComponent* InMesh, UAnimMontage* ClientAnimMontage, float ClientPosition, FName SectionName,
+	FName NextSectionName, FPredictionKey PredictionKey)
+{
+	return true;
+}
+
+void UPlayMontageAbilitySystemComponent::ServerCurrentMontageJumpToSectionNameForMesh_Implementation(
+	USkeletalMeshComponent* InMesh, UAnimMontage* ClientAnimMontage, FName SectionName, FPredictionKey PredictionKey)
+{
+	// Accepting the jump needs no reply, the key is acknowledged when the window closes
+	FScopedPredictionWindow ScopedPrediction(this, PredictionKey);
+
+	if (!CanApplyClientMontageSectionChangeForMesh(InMesh, ClientAnimMontage))
+	{
+		RejectMontageSectionPrediction(PredictionKey);
+		return;
+	}
+
+	// Jump to SectionName
+	InMesh->GetAnimInstance()->Montage_JumpToSection(SectionName, ClientAnimMontage);
+	InvalidateMontageStateSnapshotForMesh(InMesh);
+
+	// Update replicated version for Simulated Proxies if we are on the server.
+	if (IsOwnerActorAuthoritative())
+	{
+		AnimMontage_UpdateReplicatedDataForMesh(InMesh);
 	}
 }
 
 bool UPlayMontageAbilitySystemComponent::ServerCurrentMontageJumpToSectionNameForMesh_Validate(
-	USkeletalMeshComponent* InMesh, UAnimMontage* ClientAnimMontage, FName SectionName)
+	USkeletalMeshComponent* InMesh, UAnimMontage* ClientAnimMontage, FName SectionName, FPredictionKey PredictionKey)
 {
 	return true;
 }
@@ -767,15 +2518,15 @@ void UPlayMontageAbilitySystemComponent::ServerCurrentMontageSetPlayRateForMesh_
 	USkeletalMeshComponent* InMesh, UAnimMontage* ClientAnimMontage, float InPlayRate)
 {
 	UAnimInstance* AnimInstance = IsValid(InMesh) && InMesh->GetOwner() == AbilityActorInfo->AvatarActor ? InMesh->GetAnimInstance() : nullptr;
-	FGameplayAbilityLocalAnimMontageForMesh& AnimMontageInfo = GetLocalAnimMontageInfoForMesh(InMesh);
+	UAnimMontage* CurrentAnimMontage = FindLocalMontageForMesh(InMesh);
 
 	if (AnimInstance)
 	{
-		UAnimMontage* CurrentAnimMontage = AnimMontageInfo.LocalMontageInfo.AnimMontage;
 		if (ClientAnimMontage == CurrentAnimMontage)
 		{
 			// Set PlayRate
-			AnimInstance->Montage_SetPlayRate(AnimMontageInfo.LocalMontageInfo.AnimMontage, InPlayRate);
+			AnimInstance->Montage_SetPlayRate(CurrentAnimMontage, InPlayRate);
+			InvalidateMontageStateSnapshotForMesh(InMesh);
 
 			// Update replicated version for Simulated Proxies if we are on the server.
 			if (IsOwnerActorAuthoritative())
@@ -791,3 +2542,77 @@ bool UPlayMontageAbilitySystemComponent::ServerCurrentMontageSetPlayRateForMesh_
 {
 	return true;
 }
+
+void UPlayMontageAbilitySystemComponent::ServerCurrentMontageJumpToSectionNameForMeshes_Implementation(
+	const TArray<USkeletalMeshComponent*>& InMeshes, const TArray<UAnimMontage*>& ClientAnimMontages, FName SectionName,
+	FPredictionKey PredictionKey)
+{
+	FScopedPredictionWindow ScopedPrediction(this, PredictionKey);
+
+	// The group was predicted under a single key, apply all of it or none of it
+	for (int32 MeshIndex = 0; MeshIndex < InMeshes.Num(); MeshIndex++)
+	{
+		if (!CanApplyClientMontageSectionChangeForMesh(InMeshes[MeshIndex], ClientAnimMontages[MeshIndex]))
+		{
+			RejectMontageSectionPrediction(PredictionKey);
+			return;
+		}
+	}
+
+	FScopedMontageBatch MontageBatch(this);
+	for (int32 MeshIndex = 0; MeshIndex < InMeshes.Num(); MeshIndex++)
+	{
+		InMeshes[MeshIndex]->GetAnimInstance()->Montage_JumpToSection(SectionName, ClientAnimMontages[MeshIndex]);
+		InvalidateMontageStateSnapshotForMesh(InMeshes[MeshIndex]);
+		AnimMontage_UpdateReplicatedDataForMesh(InMeshes[MeshIndex]);
+	}
+}
+
+bool UPlayMontageAbilitySystemComponent::ServerCurrentMontageJumpToSectionNameForMeshes_Validate(
+	const TArray<USkeletalMeshComponent*>& InMeshes, const TArray<UAnimMontage*>& ClientAnimMontages, FName SectionName,
+	FPredictionKey PredictionKey)
+{
+	return InMeshes.Num() == ClientAnimMontages.Num();
+}
+
+void UPlayMontageAbilitySystemComponent::ServerCurrentMontageSetPlayRateForMeshes_Implementation(
+	const TArray<USkeletalMeshComponent*>& InMeshes, const TArray<UAnimMontage*>& ClientAnimMontages, const TArray<float>& InPlayRates)
+{
+	FScopedMontageBatch MontageBatch(this);
+	for (int32 MeshIndex = 0; MeshIndex < InMeshes.Num(); MeshIndex++)
+	{
+		ServerCurrentMontageSetPlayRateForMesh_Implementation(InMeshes[MeshIndex], ClientAnimMontages[MeshIndex], InPlayRates[MeshIndex]);
+	}
+}
+
+bool UPlayMontageAbilitySystemComponent::ServerCurrentMontageSetPlayRateForMeshes_Validate(
+	const TArray<USkeletalMeshComponent*>& InMeshes, const TArray<UAnimMontage*>& ClientAnimMontages, const TArray<float>& InPlayRates)
+{
+	return InMeshes.Num() == ClientAnimMontages.Num() && InMeshes.Num() == InPlayRates.Num();
+}
+
+void UPlayMontageAbilitySystemComponent::ServerUpdateMontageControlsForMesh_Implementation(
+	const TArray<FMontageControlForMesh>& Controls, uint16 Sequence)
+{
+	// Unreliable RPCs can arrive out of order, never apply an older state over a newer one
+	if ((int16)(Sequence - MontageControlSequence) <= 0)
+	{
+		return;
+	}
+	MontageControlSequence = Sequence;
+
+	FScopedMontageBatch MontageBatch(this);
+	for (const FMontageControlForMesh& Control : Controls)
+	{
+		if (Control.bSetPlayRate)
+		{
+			ServerCurrentMontageSetPlayRateForMesh_Implementation(Control.Mesh, Control.Montage, Control.PlayRate);
+		}
+	}
+}
+
+bool UPlayMontageAbilitySystemComponent::ServerUpdateMontageControlsForMesh_Validate(
+	const TArray<FMontageControlForMesh>& Controls, uint16 Sequence)
+{
+	return true;
+}
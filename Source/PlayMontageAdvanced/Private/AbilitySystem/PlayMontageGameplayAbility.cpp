@@ -3,22 +3,49 @@
 
 #include "AbilitySystem/PlayMontageGameplayAbility.h"
 
+#include "AbilitySystem/PlayMontageAbilitySystemComponent.h"
+
 #include UE_INLINE_GENERATED_CPP_BY_NAME(PlayMontageGameplayAbility)
 
 // Most of this is from GASShooter and therefore also Copyright 2024 Dan Kestranek.
 // https://github.com/tranek/GASShooter
 
 
+void UPlayMontageGameplayAbility::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)
+{
+	UPlayMontageGameplayAbility* This = CastChecked<UPlayMontageGameplayAbility>(InThis);
+	for (FAbilityMeshMontage& MeshMontage : This->CurrentAbilityMeshMontages)
+	{
+		Collector.AddReferencedObject(MeshMontage.Montage, This);
+	}
+
+	Super::AddReferencedObjects(InThis, Collector);
+}
+
+FAbilityMeshMontage* UPlayMontageGameplayAbility::FindAbilityMeshMontage(const USkeletalMeshComponent* InMesh)
+{
+	// Only a handful of meshes, scanning the inline keys is cheaper than hashing them
+	return CurrentAbilityMeshMontages.FindByPredicate([InMesh](const FAbilityMeshMontage& MeshMontage)
+	{
+		return MeshMontage.Mesh == InMesh;
+	});
+}
+
+const FAbilityMeshMontage* UPlayMontageGameplayAbility::FindAbilityMeshMontage(const USkeletalMeshComponent* InMesh) const
+{
+	return CurrentAbilityMeshMontages.FindByPredicate([InMesh](const FAbilityMeshMontage& MeshMontage)
+	{
+		return MeshMontage.Mesh == InMesh;
+	});
+}
+
 bool UPlayMontageGameplayAbility::FindAbilityMeshMontage(USkeletalMeshComponent* InMesh,
 	FAbilityMeshMontage& InAbilityMontage)
 {
-	for (FAbilityMeshMontage& MeshMontage : CurrentAbilityMeshMontages)
+	if (const FAbilityMeshMontage* MeshMontage = FindAbilityMeshMontage(InMesh))
 	{
-		if (MeshMontage.Mesh == InMesh)
-		{
-			InAbilityMontage = MeshMontage;
-			return true;
-		}
+		InAbilityMontage = *MeshMontage;
+		return true;
 	}
 
 	return false;
@@ -26,26 +53,31 @@ bool UPlayMontageGameplayAbility::FindAbilityMeshMontage(USkeletalMeshComponent*
 
 UAnimMontage* UPlayMontageGameplayAbility::GetCurrentMontageForMesh(USkeletalMeshComponent* InMesh)
 {
-	FAbilityMeshMontage AbilityMeshMontage;
-	if (FindAbilityMeshMontage(InMesh, AbilityMeshMontage))
-	{
-		return AbilityMeshMontage.Montage;
-	}
-
-	return nullptr;
+	const FAbilityMeshMontage* AbilityMeshMontage = FindAbilityMeshMontage(InMesh);
+	return AbilityMeshMontage ? AbilityMeshMontage->Montage : nullptr;
 }
 
 void UPlayMontageGameplayAbility::SetCurrentMontageForMesh(USkeletalMeshComponent* InMesh, UAnimMontage* InCurrentMontage)
 {
 	ensure(IsInstantiated());
 
-	FAbilityMeshMontage AbilityMeshMontage;
-	if (FindAbilityMeshMontage(InMesh, AbilityMeshMontage))
+	if (FAbilityMeshMontage* AbilityMeshMontage = FindAbilityMeshMontage(InMesh))
 	{
-		AbilityMeshMontage.Montage = InCurrentMontage;
+		AbilityMeshMontage->Montage = InCurrentMontage;
 	}
-	else
+	else if (InCurrentMontage)
 	{
+		// Drop the meshes that went away since, so weapon swaps don't grow the array
+		CurrentAbilityMeshMontages.RemoveAllSwap([](const FAbilityMeshMontage& MeshMontage)
+		{
+			return UPlayMontageAbilitySystemComponent::IsStaleMesh(MeshMontage.Mesh.Get());
+		});
 		CurrentAbilityMeshMontages.Add(FAbilityMeshMontage(InMesh, InCurrentMontage));
 	}
 }
+
+void UPlayMontageGameplayAbility::ClearCurrentMontagesForAllMeshes()
+{
+	// Keeps the inline storage
+	CurrentAbilityMeshMontages.Reset();
+}
@@ -1,18 +1,55 @@
 ﻿// Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "PlayMontageAdvanced.h"
+#include "PlayMontageAdvancedSectionCache.h"
+#include "PlayMontageAdvancedStats.h"
+#include "Animation/AnimMontage.h"
+#include "UObject/UObjectGlobals.h"
 
 #define LOCTEXT_NAMESPACE "FPlayMontageAdvancedModule"
 
+DEFINE_STAT(STAT_MontageRepLOD_FullRateSends);
+DEFINE_STAT(STAT_MontageRepLOD_ReducedRateSends);
+DEFINE_STAT(STAT_MontageRepLOD_SkippedRefreshes);
+DEFINE_STAT(STAT_MontageRepLOD_BytesSaved);
+DEFINE_STAT(STAT_MontageRep_AppliedEntries);
+DEFINE_STAT(STAT_MontageRep_SkippedEntries);
+DEFINE_STAT(STAT_MontageRep_PositionSnaps);
+DEFINE_STAT(STAT_MontageRep_PositionWarps);
+DEFINE_STAT(STAT_MontageRepBatch_Components);
+DEFINE_STAT(STAT_MontageRepBatch_Serial);
+DEFINE_STAT(STAT_MontageRepBatch_Gather);
+DEFINE_STAT(STAT_MontageRepBatch_Commit);
+DEFINE_STAT(STAT_MontageMeshEntries_Pruned);
+
 void FPlayMontageAdvancedModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
+
+	PostGarbageCollectHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddStatic(&FMontageSectionCache::Prune);
+
+#if WITH_EDITOR
+	// Sections can be edited while montages are in use
+	ObjectPropertyChangedHandle = FCoreUObjectDelegates::OnObjectPropertyChanged.AddLambda([](UObject* Object, FPropertyChangedEvent&)
+	{
+		if (const UAnimMontage* Montage = Cast<UAnimMontage>(Object))
+		{
+			FMontageSectionCache::Invalidate(Montage);
+		}
+	});
+#endif
 }
 
 void FPlayMontageAdvancedModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
+
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGarbageCollectHandle);
+#if WITH_EDITOR
+	FCoreUObjectDelegates::OnObjectPropertyChanged.Remove(ObjectPropertyChangedHandle);
+#endif
+	FMontageSectionCache::Flush();
 }
 
 #undef LOCTEXT_NAMESPACE
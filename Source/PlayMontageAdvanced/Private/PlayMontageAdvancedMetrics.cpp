@@ -0,0 +1,76 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+
+#include "PlayMontageAdvancedMetrics.h"
+
+#include "AbilitySystemLog.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+#include "Serialization/JsonWriter.h"
+
+static FAutoConsoleCommand MontageMetricsResetCommand(
+	TEXT("PlayMontageAdvanced.Metrics.Reset"),
+	TEXT("Resets the montage replication metrics"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		FPlayMontageAdvancedMetrics::Get().Reset();
+	})
+);
+
+static FAutoConsoleCommand MontageMetricsDumpCommand(
+	TEXT("PlayMontageAdvanced.Metrics.Dump"),
+	TEXT("Logs the montage replication metrics since the last reset as JSON. Optionally writes them to the file passed as argument"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const FPlayMontageAdvancedMetrics& Metrics = FPlayMontageAdvancedMetrics::Get();
+		ABILITY_LOG(Log, TEXT("PlayMontageAdvanced metrics: %s"), *Metrics.ToJson());
+		if (Args.Num() > 0 && !Metrics.WriteToFile(Args[0]))
+		{
+			ABILITY_LOG(Warning, TEXT("PlayMontageAdvanced metrics: failed to write %s"), *Args[0]);
+		}
+	})
+);
+
+FPlayMontageAdvancedMetrics& FPlayMontageAdvancedMetrics::Get()
+{
+	static FPlayMontageAdvancedMetrics Metrics;
+	return Metrics;
+}
+
+void FPlayMontageAdvancedMetrics::Reset()
+{
+	*this = FPlayMontageAdvancedMetrics();
+}
+
+FString FPlayMontageAdvancedMetrics::ToJson() const
+{
+	const double Duration = FMath::Max(FPlatformTime::Seconds() - StartTime, UE_SMALL_NUMBER);
+
+	FString Json;
+	const TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Json);
+	Writer->WriteObjectStart();
+	Writer->WriteValue(TEXT("Duration"), Duration);
+	Writer->WriteValue(TEXT("ReplicatedBytes"), (int64)ReplicatedBytes);
+	Writer->WriteValue(TEXT("ReplicatedBytesPerSecond"), ReplicatedBytes / Duration);
+	Writer->WriteValue(TEXT("ReplicatedUpdates"), (int64)ReplicatedUpdates);
+	Writer->WriteValue(TEXT("RPCs"), (int64)RPCs);
+	Writer->WriteValue(TEXT("RPCsPerSecond"), RPCs / Duration);
+	Writer->WriteValue(TEXT("AppliedEntries"), (int64)AppliedEntries);
+	Writer->WriteValue(TEXT("SkippedEntries"), (int64)SkippedEntries);
+	Writer->WriteValue(TEXT("PositionSnaps"), (int64)PositionSnaps);
+	Writer->WriteValue(TEXT("PositionWarps"), (int64)PositionWarps);
+	Writer->WriteValue(TEXT("CorrectionsPerSecond"), (PositionSnaps + PositionWarps) / Duration);
+	Writer->WriteValue(TEXT("SectionPredictionRejections"), (int64)SectionPredictionRejections);
+	Writer->WriteValue(TEXT("PrunedMeshEntries"), (int64)PrunedMeshEntries);
+	Writer->WriteObjectEnd();
+	Writer->Close();
+	return Json;
+}
+
+bool FPlayMontageAdvancedMetrics::WriteToFile(const FString& Filename) const
+{
+	const FString FilePath = FPaths::IsRelative(Filename) ? FPaths::Combine(FPaths::ProfilingDir(), TEXT("PlayMontageAdvanced"), Filename) : Filename;
+	return FFileHelper::SaveStringToFile(ToJson(), *FilePath);
+}
@@ -0,0 +1,163 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+
+#include "PlayMontageAdvancedSectionCache.h"
+
+#include "Algo/BinarySearch.h"
+#include "Animation/AnimMontage.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeRWLock.h"
+#include "UObject/ObjectKey.h"
+
+namespace MontageSectionCache
+{
+	static FRWLock Lock;
+	static TMap<TObjectKey<UAnimMontage>, TUniquePtr<FMontageSectionCache>> Caches;
+}
+
+static FAutoConsoleCommand MontageSectionCacheFlushCommand(
+	TEXT("PlayMontageAdvanced.SectionCache.Flush"),
+	TEXT("Discards the cached montage section metadata, use after editing montage sections at runtime"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		FMontageSectionCache::Flush();
+	})
+);
+
+const FMontageSectionCache& FMontageSectionCache::Get(const UAnimMontage* Montage)
+{
+	static const FMontageSectionCache Empty;
+	if (!Montage)
+	{
+		return Empty;
+	}
+
+	using namespace MontageSectionCache;
+	{
+		FReadScopeLock ReadLock(Lock);
+		if (const TUniquePtr<FMontageSectionCache>* Cache = Caches.Find(Montage))
+		{
+			return **Cache;
+		}
+	}
+
+	FWriteScopeLock WriteLock(Lock);
+	TUniquePtr<FMontageSectionCache>& Cache = Caches.FindOrAdd(Montage);
+	if (!Cache.IsValid())
+	{
+		Cache = MakeUnique<FMontageSectionCache>();
+		Cache->Build(Montage);
+	}
+	return *Cache;
+}
+
+const FMontageSectionCache* FMontageSectionCache::Find(const UAnimMontage* Montage)
+{
+	if (!Montage)
+	{
+		return nullptr;
+	}
+
+	FReadScopeLock ReadLock(MontageSectionCache::Lock);
+	const TUniquePtr<FMontageSectionCache>* Cache = MontageSectionCache::Caches.Find(Montage);
+	return Cache ? Cache->Get() : nullptr;
+}
+
+int32 FMontageSectionCache::FindSectionIndexFromPosition(const UAnimMontage* Montage, float Position)
+{
+	if (const FMontageSectionCache* Cache = Find(Montage))
+	{
+		return Cache->GetSectionIndexFromPosition(Position);
+	}
+	return Montage ? Montage->GetSectionIndexFromPosition(Position) : INDEX_NONE;
+}
+
+void FMontageSectionCache::Invalidate(const UAnimMontage* Montage)
+{
+	FWriteScopeLock WriteLock(MontageSectionCache::Lock);
+	MontageSectionCache::Caches.Remove(Montage);
+}
+
+void FMontageSectionCache::Flush()
+{
+	FWriteScopeLock WriteLock(MontageSectionCache::Lock);
+	MontageSectionCache::Caches.Reset();
+}
+
+void FMontageSectionCache::Prune()
+{
+	FWriteScopeLock WriteLock(MontageSectionCache::Lock);
+	for (auto It = MontageSectionCache::Caches.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().ResolveObjectPtr())
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void FMontageSectionCache::Build(const UAnimMontage* Montage)
+{
+	SourceMontage = Montage;
+	PlayLength = Montage->GetPlayLength();
+
+	const TArray<FCompositeSection>& CompositeSections = Montage->CompositeSections;
+	const int32 NumSections = CompositeSections.Num();
+	StartTimes.Reserve(NumSections);
+	Lengths.Reserve(NumSections);
+	Names.Reserve(NumSections);
+	NameToIndex.Reserve(NumSections);
+
+	for (int32 SectionIndex = 0; SectionIndex < NumSections; SectionIndex++)
+	{
+		const FCompositeSection& Section = CompositeSections[SectionIndex];
+		StartTimes.Add(Section.GetTime());
+		Names.Add(Section.SectionName);
+
+		// UAnimMontage::GetSectionIndex returns the first section with the name
+		if (!NameToIndex.Contains(Section.SectionName))
+		{
+			NameToIndex.Add(Section.SectionName, SectionIndex);
+		}
+
+		if (SectionIndex > 0 && StartTimes[SectionIndex] < StartTimes[SectionIndex - 1])
+		{
+			bSortedStartTimes = false;
+		}
+	}
+
+	for (int32 SectionIndex = 0; SectionIndex < NumSections; SectionIndex++)
+	{
+		const float EndTime = SectionIndex + 1 < NumSections ? StartTimes[SectionIndex + 1] : PlayLength;
+		Lengths.Add(EndTime - StartTimes[SectionIndex]);
+	}
+}
+
+int32 FMontageSectionCache::GetSectionIndexFromPosition(float Position) const
+{
+	if (!bSortedStartTimes)
+	{
+		return SourceMontage ? SourceMontage->GetSectionIndexFromPosition(Position) : INDEX_NONE;
+	}
+
+	// Last section starting at or before Position, matching UAnimMontage::IsWithinPos
+	const int32 SectionIndex = Algo::UpperBound(StartTimes, Position) - 1;
+	if (SectionIndex == INDEX_NONE)
+	{
+		return INDEX_NONE;
+	}
+
+	const float EndTime = SectionIndex + 1 < StartTimes.Num() ? StartTimes[SectionIndex + 1] : PlayLength + UE_KINDA_SMALL_NUMBER;
+	return Position < EndTime ? SectionIndex : INDEX_NONE;
+}
+
+float FMontageSectionCache::GetSectionTimeLeftFromPosition(float Position) const
+{
+	const int32 SectionIndex = GetSectionIndexFromPosition(Position);
+	if (SectionIndex == INDEX_NONE)
+	{
+		return -1.f;
+	}
+
+	return StartTimes[SectionIndex] + Lengths[SectionIndex] - Position;
+}
@@ -0,0 +1,66 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+
+#include "PlayMontageAdvancedSettings.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(PlayMontageAdvancedSettings)
+
+#define LOCTEXT_NAMESPACE "PlayMontageAdvancedSettings"
+
+uint8 UPlayMontageAdvancedSettings::GetBlendInPresetID(FName PresetName) const
+{
+	if (PresetName.IsNone())
+	{
+		return INVALID_BLEND_IN_PRESET_ID;
+	}
+
+	// ID is offset by one so that zero means no preset
+	const int32 MaxPresets = FMath::Min(BlendInPresets.Num(), (int32)MAX_uint8);
+	for (int32 PresetIndex = 0; PresetIndex < MaxPresets; PresetIndex++)
+	{
+		if (BlendInPresets[PresetIndex].Name == PresetName)
+		{
+			return (uint8)(PresetIndex + 1);
+		}
+	}
+
+	return INVALID_BLEND_IN_PRESET_ID;
+}
+
+const FMontageBlendSettings* UPlayMontageAdvancedSettings::GetBlendInPreset(uint8 PresetID) const
+{
+	const int32 PresetIndex = (int32)PresetID - 1;
+	return BlendInPresets.IsValidIndex(PresetIndex) ? &BlendInPresets[PresetIndex].BlendSettings : nullptr;
+}
+
+TArray<FName> UPlayMontageAdvancedSettings::GetBlendInPresetOptions()
+{
+	TArray<FName> Options = { NAME_None };
+	for (const FMontageBlendInPreset& Preset : GetDefault<UPlayMontageAdvancedSettings>()->BlendInPresets)
+	{
+		Options.Add(Preset.Name);
+	}
+	return Options;
+}
+
+const FMontageReplicationLODTier* UPlayMontageAdvancedSettings::GetMontageReplicationLODTier(float Distance) const
+{
+	const FMontageReplicationLODTier* Result = nullptr;
+	for (const FMontageReplicationLODTier& Tier : MontageReplicationLODTiers)
+	{
+		if (Distance >= Tier.MinDistance && (!Result || Tier.MinDistance > Result->MinDistance))
+		{
+			Result = &Tier;
+		}
+	}
+	return Result;
+}
+
+#if WITH_EDITOR
+FText UPlayMontageAdvancedSettings::GetSectionText() const
+{
+	return LOCTEXT("SectionText", "Play Montage Advanced");
+}
+#endif
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,157 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+
+#include "PlayMontageReplicationSubsystem.h"
+
+#include "PlayMontageAdvancedSettings.h"
+#include "PlayMontageAdvancedStats.h"
+#include "AbilitySystem/PlayMontageAbilitySystemComponent.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(PlayMontageReplicationSubsystem)
+
+static TAutoConsoleVariable<bool> CVarMontageRepBatchParallel(
+	TEXT("PlayMontageAdvanced.BatchReplication.Parallel"),
+	true,
+	TEXT("If true, the montage state of batched components is gathered in parallel before being committed on the game thread")
+);
+
+static TAutoConsoleVariable<int32> CVarMontageRepBatchMinParallelComponents(
+	TEXT("PlayMontageAdvanced.BatchReplication.MinParallelComponents"),
+	32,
+	TEXT("Minimum number of batched components before the gather runs in parallel, below it the dispatch costs more than it saves")
+);
+
+static TAutoConsoleVariable<int32> CVarMontageRepBatchMaxParallelTasks(
+	TEXT("PlayMontageAdvanced.BatchReplication.MaxParallelTasks"),
+	0,
+	TEXT("If above 0, the parallel gather is split into at most this many tasks, bounding the threads it runs on. 0 lets ParallelFor decide")
+);
+
+bool UPlayMontageReplicationSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	if (!GetDefault<UPlayMontageAdvancedSettings>()->bBatchMontageReplicationUpdates)
+	{
+		return false;
+	}
+
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UPlayMontageReplicationSubsystem::Deinitialize()
+{
+	for (UPlayMontageAbilitySystemComponent* Component : Components)
+	{
+		if (Component)
+		{
+			Component->MontageReplicationBatchIndex = INDEX_NONE;
+		}
+	}
+	Components.Reset();
+
+	Super::Deinitialize();
+}
+
+void UPlayMontageReplicationSubsystem::Tick(float DeltaTime)
+{
+	SET_DWORD_STAT(STAT_MontageRepBatch_Components, Components.Num());
+
+	// Iterate backwards, components that finished are swapped out from behind the cursor
+	for (int32 Index = Components.Num() - 1; Index >= 0; Index--)
+	{
+		if (!IsValid(Components[Index]))
+		{
+			RemoveComponentAt(Index);
+		}
+	}
+
+	if (!CVarMontageRepBatchParallel.GetValueOnGameThread() || Components.Num() < CVarMontageRepBatchMinParallelComponents.GetValueOnGameThread())
+	{
+		SCOPE_CYCLE_COUNTER(STAT_MontageRepBatch_Serial);
+		for (int32 Index = Components.Num() - 1; Index >= 0; Index--)
+		{
+			if (!Components[Index]->UpdateReplicatedMontagesForBatch())
+			{
+				RemoveComponentAt(Index);
+			}
+		}
+		return;
+	}
+
+	// Animation has been evaluated by now and nothing else runs on the game thread until the commit,
+	// so the anim instances can be read from worker threads. Each component only writes its own staging buffer
+	{
+		SCOPE_CYCLE_COUNTER(STAT_MontageRepBatch_Gather);
+		const int32 MaxParallelTasks = CVarMontageRepBatchMaxParallelTasks.GetValueOnGameThread();
+		if (MaxParallelTasks > 0)
+		{
+			// Contiguous ranges, one task each
+			const int32 NumTasks = FMath::Min(MaxParallelTasks, Components.Num());
+			const int32 ComponentsPerTask = FMath::DivideAndRoundUp(Components.Num(), NumTasks);
+			ParallelFor(NumTasks, [this, ComponentsPerTask](int32 TaskIndex)
+			{
+				const int32 EndIndex = FMath::Min((TaskIndex + 1) * ComponentsPerTask, Components.Num());
+				for (int32 Index = TaskIndex * ComponentsPerTask; Index < EndIndex; Index++)
+				{
+					Components[Index]->GatherReplicatedMontagesForBatch();
+				}
+			});
+		}
+		else
+		{
+			ParallelFor(Components.Num(), [this](int32 Index)
+			{
+				Components[Index]->GatherReplicatedMontagesForBatch();
+			});
+		}
+	}
+
+	// Dirty marking, net updates and replay recording stay on the game thread
+	{
+		SCOPE_CYCLE_COUNTER(STAT_MontageRepBatch_Commit);
+		for (int32 Index = Components.Num() - 1; Index >= 0; Index--)
+		{
+			if (!Components[Index]->CommitReplicatedMontagesForBatch())
+			{
+				RemoveComponentAt(Index);
+			}
+		}
+	}
+}
+
+TStatId UPlayMontageReplicationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPlayMontageReplicationSubsystem, STATGROUP_PlayMontageAdvanced);
+}
+
+void UPlayMontageReplicationSubsystem::RegisterComponent(UPlayMontageAbilitySystemComponent* Component)
+{
+	if (Component && Component->MontageReplicationBatchIndex == INDEX_NONE)
+	{
+		Component->MontageReplicationBatchIndex = Components.Add(Component);
+	}
+}
+
+void UPlayMontageReplicationSubsystem::UnregisterComponent(UPlayMontageAbilitySystemComponent* Component)
+{
+	if (Component && Components.IsValidIndex(Component->MontageReplicationBatchIndex) && Components[Component->MontageReplicationBatchIndex] == Component)
+	{
+		RemoveComponentAt(Component->MontageReplicationBatchIndex);
+	}
+}
+
+void UPlayMontageReplicationSubsystem::RemoveComponentAt(int32 Index)
+{
+	if (UPlayMontageAbilitySystemComponent* Removed = Components[Index])
+	{
+		Removed->MontageReplicationBatchIndex = INDEX_NONE;
+	}
+
+	Components.RemoveAtSwap(Index);
+	if (Components.IsValidIndex(Index) && Components[Index])
+	{
+		Components[Index]->MontageReplicationBatchIndex = Index;
+	}
+}
@@ -0,0 +1,245 @@
+// Copyright (c) Jared Taylor. All Rights Reserved
+
+
+#include "Serialization/PlayTagGameplayAbilityRepAnimMontageNetSerializer.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(PlayTagGameplayAbilityRepAnimMontageNetSerializer)
+
+#if UE_WITH_IRIS
+
+#include "AbilitySystem/PlayMontageAbilitySystemComponent.h"
+#include "Iris/ReplicationState/PropertyNetSerializerInfoRegistry.h"
+#include "Iris/ReplicationState/ReplicationStateDescriptorBuilder.h"
+#include "Iris/Serialization/InternalNetSerializers.h"
+#include "Iris/Serialization/NetSerializerDelegates.h"
+
+namespace UE::Net
+{
+
+/**
+ * Forwards to the struct serializer of FPlayTagGameplayAbilityRepAnimMontageForNetSerializer
+ * Quantize and Dequantize convert between the source type and the replicated representation
+ */
+struct FPlayTagGameplayAbilityRepAnimMontageNetSerializer
+{
+	// Version
+	static const uint32 Version = 0;
+
+	// Traits
+	static constexpr bool bIsForwardingSerializer = true;
+	static constexpr bool bHasCustomNetReference = true;
+	static constexpr bool bHasDynamicState = true;
+
+	// Types
+	struct FQuantizedType
+	{
+		alignas(16) uint8 QuantizedStruct[160];
+	};
+
+	typedef FPlayTagGameplayAbilityRepAnimMontage SourceType;
+	typedef FQuantizedType QuantizedType;
+	typedef FPlayTagGameplayAbilityRepAnimMontageNetSerializerConfig ConfigType;
+
+	static const ConfigType DefaultConfig;
+
+	static void Serialize(FNetSerializationContext&, const FNetSerializeArgs&);
+	static void Deserialize(FNetSerializationContext&, const FNetDeserializeArgs&);
+
+	static void SerializeDelta(FNetSerializationContext&, const FNetSerializeDeltaArgs&);
+	static void DeserializeDelta(FNetSerializationContext&, const FNetDeserializeDeltaArgs&);
+
+	static void Quantize(FNetSerializationContext&, const FNetQuantizeArgs&);
+	static void Dequantize(FNetSerializationContext&, const FNetDequantizeArgs&);
+
+	static bool IsEqual(FNetSerializationContext&, const FNetIsEqualArgs&);
+	static bool Validate(FNetSerializationContext&, const FNetValidateArgs&);
+
+	static void CloneDynamicState(FNetSerializationContext&, const FNetCloneDynamicStateArgs&);
+	static void FreeDynamicState(FNetSerializationContext&, const FNetFreeDynamicStateArgs&);
+
+	static void CollectNetReferences(FNetSerializationContext&, const FNetCollectReferencesArgs&);
+
+private:
+	typedef FPlayTagGameplayAbilityRepAnimMontageForNetSerializer ReplicatedType;
+
+	static void SourceToReplicated(const SourceType& Source, ReplicatedType& OutReplicated);
+	static void ReplicatedToSource(const ReplicatedType& Replicated, SourceType& OutSource);
+
+	class FNetSerializerRegistryDelegates final : private UE::Net::FNetSerializerRegistryDelegates
+	{
+	public:
+		virtual ~FNetSerializerRegistryDelegates();
+
+	private:
+		virtual void OnPreFreezeNetSerializerRegistry() override;
+		virtual void OnPostFreezeNetSerializerRegistry() override;
+	};
+
+	static FPlayTagGameplayAbilityRepAnimMontageNetSerializer::FNetSerializerRegistryDelegates NetSerializerRegistryDelegates;
+	static FStructNetSerializerConfig StructNetSerializerConfig;
+	static const FNetSerializer* StructNetSerializer;
+};
+
+UE_NET_IMPLEMENT_SERIALIZER(FPlayTagGameplayAbilityRepAnimMontageNetSerializer);
+
+const FPlayTagGameplayAbilityRepAnimMontageNetSerializer::ConfigType FPlayTagGameplayAbilityRepAnimMontageNetSerializer::DefaultConfig;
+FPlayTagGameplayAbilityRepAnimMontageNetSerializer::FNetSerializerRegistryDelegates FPlayTagGameplayAbilityRepAnimMontageNetSerializer::NetSerializerRegistryDelegates;
+FStructNetSerializerConfig FPlayTagGameplayAbilityRepAnimMontageNetSerializer::StructNetSerializerConfig;
+const FNetSerializer* FPlayTagGameplayAbilityRepAnimMontageNetSerializer::StructNetSerializer = &UE_NET_GET_SERIALIZER(FStructNetSerializer);
+
+void FPlayTagGameplayAbilityRepAnimMontageNetSerializer::SourceToReplicated(const SourceType& Source, ReplicatedType& OutReplicated)
+{
+	OutReplicated.RepAnimMontage = static_cast<const FGameplayAbilityRepAnimMontage&>(Source);
+
+	// Same rules as FPlayTagGameplayAbilityRepAnimMontage::NetSerialize, unused fields stay at their defaults
+	OutReplicated.bOverrideBlendIn = Source.bOverrideBlendIn;
+	OutReplicated.BlendInPresetID = Source.bOverrideBlendIn ? Source.BlendInPresetID : 0;
+	OutReplicated.BlendInOverride = Source.bOverrideBlendIn && Source.BlendInPresetID == 0 ? Source.BlendInOverride : FMontageBlendSettings();
+	OutReplicated.bDeadReckoning = Source.bDeadReckoning;
+	OutReplicated.PositionServerTime = Source.bDeadReckoning ? Source.PositionServerTime : 0.0;
+}
+
+void FPlayTagGameplayAbilityRepAnimMontageNetSerializer::ReplicatedToSource(const ReplicatedType& Replicated, SourceType& OutSource)
+{
+	static_cast<FGameplayAbilityRepAnimMontage&>(OutSource) = Replicated.RepAnimMontage;
+	OutSource.bOverrideBlendIn = Replicated.bOverrideBlendIn;
+	OutSource.BlendInPresetID = Replicated.BlendInPresetID;
+	OutSource.BlendInOverride = Replicated.BlendInOverride;
+	OutSource.bDeadReckoning = Replicated.bDeadReckoning;
+	OutSource.PositionServerTime = Replicated.PositionServerTime;
+}
+
+void FPlayTagGameplayAbilityRepAnimMontageNetSerializer::Serialize(FNetSerializationContext& Context, const FNetSerializeArgs& Args)
+{
+	FNetSerializeArgs InternalArgs = Args;
+	InternalArgs.NetSerializerConfig = NetSerializerConfigParam(&StructNetSerializerConfig);
+	StructNetSerializer->Serialize(Context, InternalArgs);
+}
+
+void FPlayTagGameplayAbilityRepAnimMontageNetSerializer::Deserialize(FNetSerializationContext& Context, const FNetDeserializeArgs& Args)
+{
+	FNetDeserializeArgs InternalArgs = Args;
+	InternalArgs.NetSerializerConfig = NetSerializerConfigParam(&StructNetSerializerConfig);
+	StructNetSerializer->Deserialize(Context, InternalArgs);
+}
+
+void FPlayTagGameplayAbilityRepAnimMontageNetSerializer::SerializeDelta(FNetSerializationContext& Context, const FNetSerializeDeltaArgs& Args)
+{
+	FNetSerializeDeltaArgs InternalArgs = Args;
+	InternalArgs.NetSerializerConfig = NetSerializerConfigParam(&StructNetSerializerConfig);
+	StructNetSerializer->SerializeDelta(Context, InternalArgs);
+}
+
+void FPlayTagGameplayAbilityRepAnimMontageNetSerializer::DeserializeDelta(FNetSerializationContext& Context, const FNetDeserializeDeltaArgs& Args)
+{
+	FNetDeserializeDeltaArgs InternalArgs = Args;
+	InternalArgs.NetSerializerConfig = NetSerializerConfigParam(&StructNetSerializerConfig);
+	StructNetSerializer->DeserializeDelta(Context, InternalArgs);
+}
+
+void FPlayTagGameplayAbilityRepAnimMontageNetSerializer::Quantize(FNetSerializationContext& Context, const FNetQuantizeArgs& Args)
+{
+	const SourceType& SourceValue = *reinterpret_cast<const SourceType*>(Args.Source);
+
+	ReplicatedType ReplicatedValue;
+	SourceToReplicated(SourceValue, ReplicatedValue);
+
+	FNetQuantizeArgs InternalArgs = Args;
+	InternalArgs.NetSerializerConfig = NetSerializerConfigParam(&StructNetSerializerConfig);
+	InternalArgs.Source = NetSerializerValuePointer(&ReplicatedValue);
+	StructNetSerializer->Quantize(Context, InternalArgs);
+}
+
+void FPlayTagGameplayAbilityRepAnimMontageNetSerializer::Dequantize(FNetSerializationContext& Context, const FNetDequantizeArgs& Args)
+{
+	ReplicatedType ReplicatedValue;
+
+	FNetDequantizeArgs InternalArgs = Args;
+	InternalArgs.NetSerializerConfig = NetSerializerConfigParam(&StructNetSerializerConfig);
+	InternalArgs.Target = NetSerializerValuePointer(&ReplicatedValue);
+	StructNetSerializer->Dequantize(Context, InternalArgs);
+
+	SourceType& TargetValue = *reinterpret_cast<SourceType*>(Args.Target);
+	ReplicatedToSource(ReplicatedValue, TargetValue);
+}
+
+bool FPlayTagGameplayAbilityRepAnimMontageNetSerializer::IsEqual(FNetSerializationContext& Context, const FNetIsEqualArgs& Args)
+{
+	FNetIsEqualArgs InternalArgs = Args;
+	InternalArgs.NetSerializerConfig = NetSerializerConfigParam(&StructNetSerializerConfig);
+	if (Args.bStateIsQuantized)
+	{
+		return StructNetSerializer->IsEqual(Context, InternalArgs);
+	}
+
+	ReplicatedType ReplicatedValue0;
+	ReplicatedType ReplicatedValue1;
+	SourceToReplicated(*reinterpret_cast<const SourceType*>(Args.Source0), ReplicatedValue0);
+	SourceToReplicated(*reinterpret_cast<const SourceType*>(Args.Source1), ReplicatedValue1);
+
+	InternalArgs.Source0 = NetSerializerValuePointer(&ReplicatedValue0);
+	InternalArgs.Source1 = NetSerializerValuePointer(&ReplicatedValue1);
+	return StructNetSerializer->IsEqual(Context, InternalArgs);
+}
+
+bool FPlayTagGameplayAbilityRepAnimMontageNetSerializer::Validate(FNetSerializationContext& Context, const FNetValidateArgs& Args)
+{
+	ReplicatedType ReplicatedValue;
+	SourceToReplicated(*reinterpret_cast<const SourceType*>(Args.Source), ReplicatedValue);
+
+	FNetValidateArgs InternalArgs = Args;
+	InternalArgs.NetSerializerConfig = NetSerializerConfigParam(&StructNetSerializerConfig);
+	InternalArgs.Source = NetSerializerValuePointer(&ReplicatedValue);
+	return StructNetSerializer->Validate(Context, InternalArgs);
+}
+
+void FPlayTagGameplayAbilityRepAnimMontageNetSerializer::CloneDynamicState(FNetSerializationContext& Context, const FNetCloneDynamicStateArgs& Args)
+{
+	FNetCloneDynamicStateArgs InternalArgs = Args;
+	InternalArgs.NetSerializerConfig = NetSerializerConfigParam(&StructNetSerializerConfig);
+	StructNetSerializer->CloneDynamicState(Context, InternalArgs);
+}
+
+void FPlayTagGameplayAbilityRepAnimMontageNetSerializer::FreeDynamicState(FNetSerializationContext& Context, const FNetFreeDynamicStateArgs& Args)
+{
+	FNetFreeDynamicStateArgs InternalArgs = Args;
+	InternalArgs.NetSerializerConfig = NetSerializerConfigParam(&StructNetSerializerConfig);
+	StructNetSerializer->FreeDynamicState(Context, InternalArgs);
+}
+
+void FPlayTagGameplayAbilityRepAnimMontageNetSerializer::CollectNetReferences(FNetSerializationContext& Context, const FNetCollectReferencesArgs& Args)
+{
+	FNetCollectReferencesArgs InternalArgs = Args;
+	InternalArgs.NetSerializerConfig = NetSerializerConfigParam(&StructNetSerializerConfig);
+	StructNetSerializer->CollectNetReferences(Context, InternalArgs);
+}
+
+static const FName PropertyNetSerializerRegistry_NAME_PlayTagGameplayAbilityRepAnimMontage("PlayTagGameplayAbilityRepAnimMontage");
+UE_NET_IMPLEMENT_NAMED_STRUCT_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_PlayTagGameplayAbilityRepAnimMontage, FPlayTagGameplayAbilityRepAnimMontageNetSerializer);
+
+FPlayTagGameplayAbilityRepAnimMontageNetSerializer::FNetSerializerRegistryDelegates::~FNetSerializerRegistryDelegates()
+{
+	UE_NET_UNREGISTER_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_PlayTagGameplayAbilityRepAnimMontage);
+}
+
+void FPlayTagGameplayAbilityRepAnimMontageNetSerializer::FNetSerializerRegistryDelegates::OnPreFreezeNetSerializerRegistry()
+{
+	UE_NET_REGISTER_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_PlayTagGameplayAbilityRepAnimMontage);
+}
+
+void FPlayTagGameplayAbilityRepAnimMontageNetSerializer::FNetSerializerRegistryDelegates::OnPostFreezeNetSerializerRegistry()
+{
+	// Build the descriptor for the replicated representation now that every serializer it uses is registered
+	const UStruct* ReplicatedStruct = FPlayTagGameplayAbilityRepAnimMontageForNetSerializer::StaticStruct();
+	StructNetSerializerConfig.StateDescriptor = FReplicationStateDescriptorBuilder::CreateDescriptorForStruct(ReplicatedStruct);
+	const FReplicationStateDescriptor* Descriptor = StructNetSerializerConfig.StateDescriptor.GetReference();
+	check(Descriptor != nullptr);
+
+	checkf(sizeof(FQuantizedType) >= Descriptor->InternalSize && alignof(FQuantizedType) >= Descriptor->InternalAlignment,
+		TEXT("FPlayTagGameplayAbilityRepAnimMontageNetSerializer::FQuantizedType must be at least %u bytes with %u alignment"),
+		Descriptor->InternalSize, Descriptor->InternalAlignment);
+}
+
+}
+
+#endif
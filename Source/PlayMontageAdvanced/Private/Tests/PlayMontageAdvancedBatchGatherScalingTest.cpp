@@ -0,0 +1,216 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_EDITOR
+
+#include "PlayMontageAdvancedNetTestSession.h"
+#include "PlayMontageAdvancedSettings.h"
+#include "PlayMontageAdvancedTestTypes.h"
+#include "PlayMontageReplicationSubsystem.h"
+#include "AbilitySystem/PlayMontageAbilitySystemComponent.h"
+#include "Animation/AnimMontage.h"
+#include "Animation/Skeleton.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FPlayMontageAdvancedBatchGatherScalingTest, "PlayMontageAdvanced.Perf.BatchGatherScaling",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+namespace BatchGatherScalingTest
+{
+	constexpr int32 ComponentCounts[] = { 32, 128, 512, 2048 };
+	constexpr int32 NumPassesPerRun = 20;
+
+	/** Console variables the test overrides, restored once it ends */
+	struct FSavedCVar
+	{
+		IConsoleVariable* CVar = nullptr;
+		FString Value;
+	};
+
+	/** Keeps every avatar playing the montage, the subsystem drops components once their montage ends */
+	void DriveAvatars(const TArray<TWeakObjectPtr<APlayMontageAdvancedTestAvatar>>& Avatars)
+	{
+		for (const TWeakObjectPtr<APlayMontageAdvancedTestAvatar>& Avatar : Avatars)
+		{
+			UPlayMontageAbilitySystemComponent* ASC = Avatar.IsValid() ? Avatar->GetPlayMontageAbilitySystem() : nullptr;
+			FGameplayAbilitySpec* Spec = ASC ? ASC->FindAbilitySpecFromClass(UPlayMontageAdvancedTestAbility::StaticClass()) : nullptr;
+			if (Spec && !Spec->IsActive())
+			{
+				ASC->TryActivateAbility(Spec->Handle);
+			}
+		}
+	}
+
+	/** @return Milliseconds per subsystem pass, averaged over NumPassesPerRun */
+	double TimePasses(UPlayMontageReplicationSubsystem& Subsystem, float DeltaTime)
+	{
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		for (int32 Pass = 0; Pass < NumPassesPerRun; Pass++)
+		{
+			Subsystem.Tick(DeltaTime);
+		}
+		return FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) / NumPassesPerRun;
+	}
+}
+
+/** One test per montage in the project */
+void FPlayMontageAdvancedBatchGatherScalingTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	TArray<FAssetData> Assets;
+	FAssetRegistryModule::GetRegistry().GetAssetsByClass(UAnimMontage::StaticClass()->GetClassPathName(), Assets);
+	for (const FAssetData& Asset : Assets)
+	{
+		if (Asset.PackageName.ToString().StartsWith(TEXT("/Game/")))
+		{
+			OutBeautifiedNames.Add(Asset.AssetName.ToString());
+			OutTestCommands.Add(Asset.GetObjectPathString());
+		}
+	}
+}
+
+/**
+ * Times UPlayMontageReplicationSubsystem passes over avatars playing the montage on a listen server
+ * For each component count the gather runs serially, then split into 1, 2, 4... tasks up to one per worker thread,
+ * then with ParallelFor left to decide. Reports milliseconds per pass and the speedup over the serial gather
+ */
+bool FPlayMontageAdvancedBatchGatherScalingTest::RunTest(const FString& Parameters)
+{
+	using namespace PlayMontageAdvancedTests;
+	using namespace BatchGatherScalingTest;
+
+	UAnimMontage* Montage = LoadObject<UAnimMontage>(nullptr, *Parameters);
+	USkeleton* Skeleton = Montage ? Montage->GetSkeleton() : nullptr;
+	USkeletalMesh* SkeletalMesh = Skeleton ? Skeleton->GetPreviewMesh(true) : nullptr;
+	if (!TestNotNull(TEXT("Montage"), Montage) || !TestNotNull(TEXT("Skeletal mesh for the montage's skeleton"), SkeletalMesh))
+	{
+		return false;
+	}
+
+	IConsoleManager& ConsoleManager = IConsoleManager::Get();
+	IConsoleVariable* ParallelCVar = ConsoleManager.FindConsoleVariable(TEXT("PlayMontageAdvanced.BatchReplication.Parallel"));
+	IConsoleVariable* MinParallelComponentsCVar = ConsoleManager.FindConsoleVariable(TEXT("PlayMontageAdvanced.BatchReplication.MinParallelComponents"));
+	IConsoleVariable* MaxParallelTasksCVar = ConsoleManager.FindConsoleVariable(TEXT("PlayMontageAdvanced.BatchReplication.MaxParallelTasks"));
+	if (!TestNotNull(TEXT("Batch replication console variables"), ParallelCVar) || !MinParallelComponentsCVar || !MaxParallelTasksCVar)
+	{
+		return false;
+	}
+
+	TSharedRef<TArray<FSavedCVar>> SavedCVars = MakeShared<TArray<FSavedCVar>>();
+	for (IConsoleVariable* CVar : { ParallelCVar, MinParallelComponentsCVar, MaxParallelTasksCVar })
+	{
+		SavedCVars->Add({ CVar, CVar->GetString() });
+	}
+	MinParallelComponentsCVar->Set(1, ECVF_SetByCode);
+
+	// The subsystem is only created for worlds started with batching enabled
+	UPlayMontageAdvancedSettings* Settings = GetMutableDefault<UPlayMontageAdvancedSettings>();
+	const bool bWasBatching = Settings->bBatchMontageReplicationUpdates;
+	Settings->bBatchMontageReplicationUpdates = true;
+
+	// The game thread takes part in ParallelFor
+	const int32 MaxThreads = FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+
+	TSharedRef<FNetTestSession> Session = MakeShared<FNetTestSession>(*this, FNetTestSessionParams());
+	TSharedRef<TArray<TWeakObjectPtr<APlayMontageAdvancedTestAvatar>>> Avatars = MakeShared<TArray<TWeakObjectPtr<APlayMontageAdvancedTestAvatar>>>();
+	Session->QueueStart();
+
+	Session->QueueUntil([this, Session]()
+	{
+		if (!Session->GetServerWorld()->GetSubsystem<UPlayMontageReplicationSubsystem>())
+		{
+			AddError(TEXT("The montage replication subsystem wasn't created for the server world"));
+		}
+		return true;
+	});
+
+	for (const int32 NumComponents : ComponentCounts)
+	{
+		Session->QueueUntil([this, Session, Avatars, Montage, SkeletalMesh, NumComponents]()
+		{
+			UWorld* ServerWorld = Session->GetServerWorld();
+			while (Avatars->Num() < NumComponents)
+			{
+				const int32 Index = Avatars->Num();
+				const FVector Location(200.f * (Index % 64), 200.f * (Index / 64), 0.f);
+				APlayMontageAdvancedTestAvatar* Avatar = ServerWorld->SpawnActor<APlayMontageAdvancedTestAvatar>(Location, FRotator::ZeroRotator);
+				if (!Avatar)
+				{
+					AddError(TEXT("Failed to spawn the test avatars"));
+					break;
+				}
+				Avatar->SetSkeletalMesh(SkeletalMesh);
+				Avatar->TestMontage = Montage;
+				Avatar->GetPlayMontageAbilitySystem()->GiveAbility(FGameplayAbilitySpec(UPlayMontageAdvancedTestAbility::StaticClass()));
+				Avatars->Add(Avatar);
+			}
+			DriveAvatars(*Avatars);
+			return true;
+		});
+
+		// Let the montages start and the anim instances evaluate them
+		Session->QueueWaitFrames(10);
+
+		Session->QueueUntil([this, Session, Avatars, ParallelCVar, MaxParallelTasksCVar, MaxThreads]()
+		{
+			DriveAvatars(*Avatars);
+
+			UWorld* ServerWorld = Session->GetServerWorld();
+			UPlayMontageReplicationSubsystem* Subsystem = ServerWorld->GetSubsystem<UPlayMontageReplicationSubsystem>();
+			if (!Subsystem)
+			{
+				return true;
+			}
+
+			const float DeltaTime = ServerWorld->GetDeltaSeconds();
+			const int32 NumRegistered = Subsystem->GetNumRegisteredComponents();
+
+			ParallelCVar->Set(false, ECVF_SetByCode);
+			const double SerialMs = TimePasses(*Subsystem, DeltaTime);
+			AddInfo(FString::Printf(TEXT("%d components, serial: %.3f ms per pass"), NumRegistered, SerialMs));
+
+			ParallelCVar->Set(true, ECVF_SetByCode);
+			for (int32 NumTasks = 1; ; NumTasks = FMath::Min(NumTasks * 2, MaxThreads))
+			{
+				MaxParallelTasksCVar->Set(NumTasks, ECVF_SetByCode);
+				const double ParallelMs = TimePasses(*Subsystem, DeltaTime);
+				AddInfo(FString::Printf(TEXT("%d components, %d tasks: %.3f ms per pass, %.2fx serial"),
+					NumRegistered, NumTasks, ParallelMs, ParallelMs > 0.0 ? SerialMs / ParallelMs : 0.0));
+
+				if (NumTasks == MaxThreads)
+				{
+					break;
+				}
+			}
+
+			MaxParallelTasksCVar->Set(0, ECVF_SetByCode);
+			const double ParallelForMs = TimePasses(*Subsystem, DeltaTime);
+			AddInfo(FString::Printf(TEXT("%d components, ParallelFor: %.3f ms per pass, %.2fx serial"),
+				NumRegistered, ParallelForMs, ParallelForMs > 0.0 ? SerialMs / ParallelForMs : 0.0));
+
+			TestTrue(TEXT("Components with playing montages were batched"), NumRegistered > 0);
+			return true;
+		});
+	}
+
+	Session->QueueEnd();
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([Settings, bWasBatching, SavedCVars]()
+	{
+		Settings->bBatchMontageReplicationUpdates = bWasBatching;
+		for (const FSavedCVar& Saved : *SavedCVars)
+		{
+			Saved.CVar->Set(*Saved.Value, ECVF_SetByCode);
+		}
+		return true;
+	}));
+
+	return true;
+}
+
+#endif
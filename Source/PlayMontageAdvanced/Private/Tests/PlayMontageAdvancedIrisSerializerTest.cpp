@@ -0,0 +1,137 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && UE_WITH_IRIS
+
+#include "PlayMontageAdvancedTestUtils.h"
+#include "Serialization/PlayTagGameplayAbilityRepAnimMontageNetSerializer.h"
+#include "Iris/ReplicationState/ReplicationStateDescriptorBuilder.h"
+#include "Iris/ReplicationSystem/ReplicationBridge.h"
+#include "Iris/ReplicationSystem/ReplicationSystem.h"
+#include "Iris/Serialization/InternalNetSerializationContext.h"
+#include "Iris/Serialization/NetBitStreamReader.h"
+#include "Iris/Serialization/NetBitStreamWriter.h"
+#include "Iris/Serialization/NetSerializationContext.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPlayMontageAdvancedIrisSerializerTest, "PlayMontageAdvanced.Replication.IrisSerializer",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FPlayMontageAdvancedIrisSerializerTest::RunTest(const FString& Parameters)
+{
+	using namespace PlayMontageAdvancedTests;
+	using namespace UE::Net;
+
+	const FNetSerializer& Serializer = UE_NET_GET_SERIALIZER(FPlayTagGameplayAbilityRepAnimMontageNetSerializer);
+
+	// FQuantizedType is a fixed size buffer, it has to hold the quantized state of the replicated representation
+	const TRefCountPtr<const FReplicationStateDescriptor> Descriptor = FReplicationStateDescriptorBuilder::CreateDescriptorForStruct(
+		FPlayTagGameplayAbilityRepAnimMontageForNetSerializer::StaticStruct());
+	if (!TestNotNull(TEXT("Replicated representation descriptor"), Descriptor.GetReference()))
+	{
+		return false;
+	}
+	TestTrue(FString::Printf(TEXT("Quantized size %u fits in %u bytes"), Descriptor->InternalSize, Serializer.QuantizedTypeSize),
+		Descriptor->InternalSize <= Serializer.QuantizedTypeSize);
+	TestTrue(FString::Printf(TEXT("Quantized alignment %u fits in %u"), Descriptor->InternalAlignment, Serializer.QuantizedTypeAlignment),
+		Descriptor->InternalAlignment <= Serializer.QuantizedTypeAlignment);
+	AddInfo(FString::Printf(TEXT("Quantized state: %u of %u bytes"), Descriptor->InternalSize, Serializer.QuantizedTypeSize));
+
+	// Object references are quantized through the replication system's reference cache
+	UReplicationSystem::FReplicationSystemParams Params;
+	Params.ReplicationBridge = NewObject<UReplicationBridge>();
+	Params.bIsServer = true;
+	Params.bAllowObjectReplication = false;
+	UReplicationSystem* ReplicationSystem = FReplicationSystemFactory::CreateReplicationSystem(Params);
+	if (!TestNotNull(TEXT("Replication system"), ReplicationSystem))
+	{
+		return false;
+	}
+
+	FInternalNetSerializationContext InternalContext(ReplicationSystem);
+
+	for (FRepAnimMontageTestCase& Case : MakeRepAnimMontageTestCases())
+	{
+		// Transient objects have no stable name to reference, so both paths run without object references
+		FPlayTagGameplayAbilityRepAnimMontage& Source = Case.RepAnimMontage;
+		Source.Animation = nullptr;
+		Source.BlendInOverride.Blend.CustomCurve = nullptr;
+
+		// Legacy NetSerialize
+		FPlayTagGameplayAbilityRepAnimMontage LegacyResult;
+		bool bLegacyError = false;
+		const int64 LegacyBits = RoundTripNetSerialize(Source, LegacyResult, bLegacyError);
+		TestFalse(FString::Printf(TEXT("%s: NetSerialize error"), Case.Name), bLegacyError);
+		TestRepAnimMontageRoundTrip(*this, FString::Printf(TEXT("%s NetSerialize"), Case.Name), Source, LegacyResult);
+
+		// Iris: quantize, serialize, deserialize, dequantize
+		TArray<uint8, TAlignedHeapAllocator<16>> Quantized;
+		TArray<uint8, TAlignedHeapAllocator<16>> ReceivedQuantized;
+		Quantized.SetNumZeroed(Serializer.QuantizedTypeSize);
+		ReceivedQuantized.SetNumZeroed(Serializer.QuantizedTypeSize);
+
+		alignas(16) uint8 Buffer[1024] = {};
+
+		FNetBitStreamWriter Writer;
+		Writer.InitBytes(Buffer, sizeof(Buffer));
+		FNetSerializationContext WriteContext(&Writer);
+		WriteContext.SetInternalContext(&InternalContext);
+
+		FNetQuantizeArgs QuantizeArgs;
+		QuantizeArgs.Version = 0;
+		QuantizeArgs.NetSerializerConfig = NetSerializerConfigParam(Serializer.DefaultConfig);
+		QuantizeArgs.Source = NetSerializerValuePointer(&Source);
+		QuantizeArgs.Target = NetSerializerValuePointer(Quantized.GetData());
+		Serializer.Quantize(WriteContext, QuantizeArgs);
+
+		FNetSerializeArgs SerializeArgs;
+		SerializeArgs.Version = 0;
+		SerializeArgs.NetSerializerConfig = NetSerializerConfigParam(Serializer.DefaultConfig);
+		SerializeArgs.Source = NetSerializerValuePointer(Quantized.GetData());
+		Serializer.Serialize(WriteContext, SerializeArgs);
+		Writer.CommitWrites();
+
+		const uint32 IrisBits = Writer.GetPosBits();
+		TestFalse(FString::Printf(TEXT("%s: Iris write error"), Case.Name), WriteContext.HasError() || Writer.IsOverflown());
+
+		FNetBitStreamReader Reader;
+		Reader.InitBits(Buffer, IrisBits);
+		FNetSerializationContext ReadContext(&Reader);
+		ReadContext.SetInternalContext(&InternalContext);
+
+		FNetDeserializeArgs DeserializeArgs;
+		DeserializeArgs.Version = 0;
+		DeserializeArgs.NetSerializerConfig = NetSerializerConfigParam(Serializer.DefaultConfig);
+		DeserializeArgs.Target = NetSerializerValuePointer(ReceivedQuantized.GetData());
+		Serializer.Deserialize(ReadContext, DeserializeArgs);
+		TestFalse(FString::Printf(TEXT("%s: Iris read error"), Case.Name), ReadContext.HasError() || Reader.IsOverflown());
+		TestEqual(FString::Printf(TEXT("%s: Iris bits read"), Case.Name), Reader.GetPosBits(), IrisBits);
+
+		FPlayTagGameplayAbilityRepAnimMontage IrisResult;
+		FNetDequantizeArgs DequantizeArgs;
+		DequantizeArgs.Version = 0;
+		DequantizeArgs.NetSerializerConfig = NetSerializerConfigParam(Serializer.DefaultConfig);
+		DequantizeArgs.Source = NetSerializerValuePointer(ReceivedQuantized.GetData());
+		DequantizeArgs.Target = NetSerializerValuePointer(&IrisResult);
+		Serializer.Dequantize(ReadContext, DequantizeArgs);
+		TestRepAnimMontageRoundTrip(*this, FString::Printf(TEXT("%s Iris"), Case.Name), Source, IrisResult);
+
+		for (TArray<uint8, TAlignedHeapAllocator<16>>* State : { &Quantized, &ReceivedQuantized })
+		{
+			FNetFreeDynamicStateArgs FreeArgs;
+			FreeArgs.Version = 0;
+			FreeArgs.NetSerializerConfig = NetSerializerConfigParam(Serializer.DefaultConfig);
+			FreeArgs.Source = NetSerializerValuePointer(State->GetData());
+			Serializer.FreeDynamicState(WriteContext, FreeArgs);
+		}
+
+		AddInfo(FString::Printf(TEXT("%s: NetSerialize %lld bits, Iris %u bits"), Case.Name, LegacyBits, IrisBits));
+	}
+
+	FReplicationSystemFactory::DestroyReplicationSystem(ReplicationSystem);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,158 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_EDITOR
+
+#include "PlayMontageAdvancedNetTestSession.h"
+#include "PlayMontageAdvancedTestTypes.h"
+#include "AbilitySystem/PlayMontageAbilitySystemComponent.h"
+#include "Animation/AnimInstance.h"
+#include "Animation/AnimMontage.h"
+#include "Animation/Skeleton.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/World.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPlayMontageAdvancedMeshSwapTest, "PlayMontageAdvanced.MeshEntries.MeshSwap",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+namespace MeshSwapTest
+{
+	constexpr int32 NumSwaps = 16;
+
+	struct FState
+	{
+		TWeakObjectPtr<APlayMontageAdvancedTestAvatar> Avatar;
+		TWeakObjectPtr<USkeletalMeshComponent> SwappedMesh;
+		int32 NumSwapsDone = 0;
+		int32 BaselineEntries = INDEX_NONE;
+		int32 MaxEntries = 0;
+	};
+
+	/** First montage in the project whose skeleton has a preview mesh */
+	UAnimMontage* FindTestMontage(USkeletalMesh*& OutSkeletalMesh)
+	{
+		TArray<FAssetData> Assets;
+		FAssetRegistryModule::GetRegistry().GetAssetsByClass(UAnimMontage::StaticClass()->GetClassPathName(), Assets);
+		for (const FAssetData& Asset : Assets)
+		{
+			if (!Asset.PackageName.ToString().StartsWith(TEXT("/Game/")))
+			{
+				continue;
+			}
+
+			UAnimMontage* Montage = Cast<UAnimMontage>(Asset.GetAsset());
+			USkeleton* Skeleton = Montage ? Montage->GetSkeleton() : nullptr;
+			OutSkeletalMesh = Skeleton ? Skeleton->GetPreviewMesh(true) : nullptr;
+			if (OutSkeletalMesh)
+			{
+				return Montage;
+			}
+		}
+		return nullptr;
+	}
+
+	/** Destroys the previous weapon mesh, attaches a new one to the avatar and plays the montage on it with replication */
+	void SwapMesh(FState& State, USkeletalMesh* SkeletalMesh, UAnimMontage* Montage)
+	{
+		APlayMontageAdvancedTestAvatar* Avatar = State.Avatar.Get();
+		if (USkeletalMeshComponent* PreviousMesh = State.SwappedMesh.Get())
+		{
+			PreviousMesh->DestroyComponent();
+		}
+
+		USkeletalMeshComponent* NewMesh = NewObject<USkeletalMeshComponent>(Avatar);
+		NewMesh->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+		NewMesh->SetupAttachment(Avatar->GetRootComponent());
+		NewMesh->RegisterComponent();
+		NewMesh->SetSkeletalMesh(SkeletalMesh);
+		NewMesh->SetAnimInstanceClass(UAnimInstance::StaticClass());
+		State.SwappedMesh = NewMesh;
+
+		Avatar->GetPlayMontageAbilitySystem()->PlayMontageForMesh(nullptr, NewMesh, FGameplayAbilityActivationInfo(), Montage,
+			1.f, false, FMontageBlendSettings());
+		State.NumSwapsDone++;
+	}
+}
+
+/**
+ * Swaps a weapon mesh on a live avatar over and over, playing a replicated montage on each new mesh
+ * Entries of the destroyed meshes must be reclaimed without the avatar changing or PruneStaleMeshEntries being called
+ */
+bool FPlayMontageAdvancedMeshSwapTest::RunTest(const FString& Parameters)
+{
+	using namespace PlayMontageAdvancedTests;
+	using namespace MeshSwapTest;
+
+	USkeletalMesh* SkeletalMesh = nullptr;
+	UAnimMontage* Montage = FindTestMontage(SkeletalMesh);
+	if (!Montage)
+	{
+		AddWarning(TEXT("No montage in the project has a skeleton with a preview mesh, nothing to test"));
+		return true;
+	}
+
+	TSharedRef<FNetTestSession> Session = MakeShared<FNetTestSession>(*this, FNetTestSessionParams());
+	TSharedRef<FState> State = MakeShared<FState>();
+	Session->QueueStart();
+
+	Session->QueueUntil([this, Session, State, SkeletalMesh]()
+	{
+		APlayMontageAdvancedTestAvatar* Avatar = Session->GetServerWorld()->SpawnActor<APlayMontageAdvancedTestAvatar>();
+		if (!TestNotNull(TEXT("Avatar"), Avatar))
+		{
+			return true;
+		}
+		Avatar->SetSkeletalMesh(SkeletalMesh);
+		State->Avatar = Avatar;
+		return true;
+	});
+
+	for (int32 Swap = 0; Swap < NumSwaps; Swap++)
+	{
+		Session->QueueUntil([State, SkeletalMesh, Montage]()
+		{
+			if (State->Avatar.IsValid())
+			{
+				SwapMesh(*State, SkeletalMesh, Montage);
+			}
+			return true;
+		});
+
+		// Give the ability system component a replication update to drop the destroyed mesh's entry
+		Session->QueueWaitFrames(2);
+
+		Session->QueueUntil([this, State]()
+		{
+			if (!State->Avatar.IsValid())
+			{
+				return true;
+			}
+
+			const int32 NumEntries = State->Avatar->GetPlayMontageAbilitySystem()->GetNumMeshEntries();
+			if (State->BaselineEntries == INDEX_NONE)
+			{
+				State->BaselineEntries = NumEntries;
+			}
+			State->MaxEntries = FMath::Max(State->MaxEntries, NumEntries);
+			return true;
+		});
+	}
+
+	Session->QueueUntil([this, State]()
+	{
+		TestEqual(TEXT("Mesh swaps"), State->NumSwapsDone, NumSwaps);
+		TestTrue(TEXT("The swapped mesh has entries"), State->BaselineEntries > 0);
+		TestEqual(TEXT("Mesh entries after every swap"), State->MaxEntries, State->BaselineEntries);
+		return true;
+	});
+
+	Session->QueueEnd();
+
+	return true;
+}
+
+#endif
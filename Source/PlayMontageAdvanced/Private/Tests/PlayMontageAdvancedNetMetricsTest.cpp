@@ -0,0 +1,185 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_EDITOR
+
+#include "PlayMontageAdvancedMetrics.h"
+#include "PlayMontageAdvancedNetTestSession.h"
+#include "PlayMontageAdvancedTestTypes.h"
+#include "AbilitySystem/PlayMontageAbilitySystemComponent.h"
+#include "Animation/AnimMontage.h"
+#include "Animation/Skeleton.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarNetMetricsTestNumClients(
+	TEXT("PlayMontageAdvanced.Test.NetMetrics.NumClients"),
+	4,
+	TEXT("Number of clients connected to the listen server by PlayMontageAdvanced.Perf.NetMetrics")
+);
+
+static TAutoConsoleVariable<int32> CVarNetMetricsTestNumAvatars(
+	TEXT("PlayMontageAdvanced.Test.NetMetrics.NumAvatars"),
+	16,
+	TEXT("Number of avatars playing the montage in PlayMontageAdvanced.Perf.NetMetrics")
+);
+
+static TAutoConsoleVariable<int32> CVarNetMetricsTestPacketLag(
+	TEXT("PlayMontageAdvanced.Test.NetMetrics.PacketLag"),
+	100,
+	TEXT("Emulated packet latency in milliseconds, on the server and the clients")
+);
+
+static TAutoConsoleVariable<int32> CVarNetMetricsTestPacketLoss(
+	TEXT("PlayMontageAdvanced.Test.NetMetrics.PacketLoss"),
+	2,
+	TEXT("Emulated packet loss percentage, on the server and the clients")
+);
+
+static TAutoConsoleVariable<float> CVarNetMetricsTestDuration(
+	TEXT("PlayMontageAdvanced.Test.NetMetrics.Duration"),
+	20.f,
+	TEXT("Seconds the metrics are recorded for")
+);
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FPlayMontageAdvancedNetMetricsTest, "PlayMontageAdvanced.Perf.NetMetrics",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+/** One test per montage in the project */
+void FPlayMontageAdvancedNetMetricsTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	TArray<FAssetData> Assets;
+	FAssetRegistryModule::GetRegistry().GetAssetsByClass(UAnimMontage::StaticClass()->GetClassPathName(), Assets);
+	for (const FAssetData& Asset : Assets)
+	{
+		if (Asset.PackageName.ToString().StartsWith(TEXT("/Game/")))
+		{
+			OutBeautifiedNames.Add(Asset.AssetName.ToString());
+			OutTestCommands.Add(Asset.GetObjectPathString());
+		}
+	}
+}
+
+/**
+ * Plays the montage with UAbilityTask_PlayMontageAdvanced on avatars of a listen server with clients connected
+ * through emulated lag and loss, then writes the montage replication metrics as JSON to the profiling directory
+ * The scenario is configured with the PlayMontageAdvanced.Test.NetMetrics console variables
+ */
+bool FPlayMontageAdvancedNetMetricsTest::RunTest(const FString& Parameters)
+{
+	using namespace PlayMontageAdvancedTests;
+
+	UAnimMontage* Montage = LoadObject<UAnimMontage>(nullptr, *Parameters);
+	USkeleton* Skeleton = Montage ? Montage->GetSkeleton() : nullptr;
+	USkeletalMesh* SkeletalMesh = Skeleton ? Skeleton->GetPreviewMesh(true) : nullptr;
+	if (!TestNotNull(TEXT("Montage"), Montage) || !TestNotNull(TEXT("Skeletal mesh for the montage's skeleton"), SkeletalMesh))
+	{
+		return false;
+	}
+
+	FNetTestSessionParams Params;
+	Params.NumClients = FMath::Max(CVarNetMetricsTestNumClients.GetValueOnGameThread(), 1);
+	Params.PacketLagMs = CVarNetMetricsTestPacketLag.GetValueOnGameThread();
+	Params.PacketLossPercent = CVarNetMetricsTestPacketLoss.GetValueOnGameThread();
+
+	const int32 NumAvatars = FMath::Max(CVarNetMetricsTestNumAvatars.GetValueOnGameThread(), 1);
+	const double Duration = FMath::Max(CVarNetMetricsTestDuration.GetValueOnGameThread(), 1.f);
+
+	TSharedRef<FNetTestSession> Session = MakeShared<FNetTestSession>(*this, Params);
+	TSharedRef<TArray<TWeakObjectPtr<APlayMontageAdvancedTestAvatar>>> Avatars = MakeShared<TArray<TWeakObjectPtr<APlayMontageAdvancedTestAvatar>>>();
+	Session->QueueStart();
+
+	Session->QueueUntil([this, Session, Avatars, Montage, SkeletalMesh, NumAvatars]()
+	{
+		UWorld* ServerWorld = Session->GetServerWorld();
+		for (int32 Index = 0; Index < NumAvatars; Index++)
+		{
+			const FVector Location(200.f * (Index % 8), 200.f * (Index / 8), 0.f);
+			APlayMontageAdvancedTestAvatar* Avatar = ServerWorld->SpawnActor<APlayMontageAdvancedTestAvatar>(Location, FRotator::ZeroRotator);
+			if (!Avatar)
+			{
+				AddError(TEXT("Failed to spawn the test avatars"));
+				break;
+			}
+			Avatar->SetSkeletalMesh(SkeletalMesh);
+			Avatar->TestMontage = Montage;
+			Avatar->GetPlayMontageAbilitySystem()->GiveAbility(FGameplayAbilitySpec(UPlayMontageAdvancedTestAbility::StaticClass()));
+			Avatars->Add(Avatar);
+		}
+		return true;
+	});
+
+	// Keeps every avatar playing the montage, changing the play rate now and then so proxies have to correct
+	auto DriveAvatars = [Avatars]()
+	{
+		for (const TWeakObjectPtr<APlayMontageAdvancedTestAvatar>& Avatar : *Avatars)
+		{
+			UPlayMontageAbilitySystemComponent* ASC = Avatar.IsValid() ? Avatar->GetPlayMontageAbilitySystem() : nullptr;
+			FGameplayAbilitySpec* Spec = ASC ? ASC->FindAbilitySpecFromClass(UPlayMontageAdvancedTestAbility::StaticClass()) : nullptr;
+			if (!Spec)
+			{
+				continue;
+			}
+
+			if (!Spec->IsActive())
+			{
+				ASC->TryActivateAbility(Spec->Handle);
+			}
+			else if (FMath::FRand() < 0.01f)
+			{
+				if (UPlayMontageAdvancedTestAbility* Ability = Cast<UPlayMontageAdvancedTestAbility>(Spec->GetPrimaryInstance()))
+				{
+					Ability->SetPlayRate(FMath::FRandRange(0.75f, 1.25f));
+				}
+			}
+		}
+	};
+
+	// Let the initial replication of the avatars settle before recording
+	TSharedRef<double> WarmupEndTime = MakeShared<double>(0.0);
+	Session->QueueUntil([DriveAvatars, WarmupEndTime]()
+	{
+		if (*WarmupEndTime == 0.0)
+		{
+			*WarmupEndTime = FPlatformTime::Seconds() + 2.0;
+		}
+		DriveAvatars();
+		return FPlatformTime::Seconds() >= *WarmupEndTime;
+	});
+
+	TSharedRef<double> RecordEndTime = MakeShared<double>(0.0);
+	Session->QueueUntil([DriveAvatars, RecordEndTime, Duration]()
+	{
+		if (*RecordEndTime == 0.0)
+		{
+			FPlayMontageAdvancedMetrics::Get().Reset();
+			*RecordEndTime = FPlatformTime::Seconds() + Duration;
+		}
+		DriveAvatars();
+		return FPlatformTime::Seconds() >= *RecordEndTime;
+	});
+
+	Session->QueueUntil([this, Session, Montage, NumAvatars]()
+	{
+		const FNetTestSessionParams& SessionParams = Session->GetParams();
+		const FString Filename = FString::Printf(TEXT("NetMetrics-%s-%dc-%da-%dms-%dpct.json"), *Montage->GetName(),
+			SessionParams.NumClients, NumAvatars, SessionParams.PacketLagMs, SessionParams.PacketLossPercent);
+
+		const FPlayMontageAdvancedMetrics& Metrics = FPlayMontageAdvancedMetrics::Get();
+		AddInfo(FString::Printf(TEXT("%s: %s"), *Filename, *Metrics.ToJson()));
+		TestTrue(TEXT("Montage entries were replicated"), Metrics.ReplicatedUpdates > 0);
+		TestTrue(TEXT("Simulated proxies applied montage entries"), Metrics.AppliedEntries > 0);
+		TestTrue(FString::Printf(TEXT("Wrote %s"), *Filename), Metrics.WriteToFile(Filename));
+		return true;
+	});
+
+	Session->QueueEnd();
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,40 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "PlayMontageAdvancedSettings.h"
+#include "PlayMontageAdvancedTestUtils.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPlayMontageAdvancedNetSerializeTest, "PlayMontageAdvanced.Replication.NetSerialize",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FPlayMontageAdvancedNetSerializeTest::RunTest(const FString& Parameters)
+{
+	using namespace PlayMontageAdvancedTests;
+
+	for (const FRepAnimMontageTestCase& Case : MakeRepAnimMontageTestCases())
+	{
+		FPlayTagGameplayAbilityRepAnimMontage Result;
+		bool bError = false;
+		const int64 NumBits = RoundTripNetSerialize(Case.RepAnimMontage, Result, bError);
+		TestFalse(FString::Printf(TEXT("%s: serialization error"), Case.Name), bError);
+		TestRepAnimMontageRoundTrip(*this, Case.Name, Case.RepAnimMontage, Result);
+
+		// The full override is quantized to whole milliseconds
+		const FPlayTagGameplayAbilityRepAnimMontage& Source = Case.RepAnimMontage;
+		if (Source.bOverrideBlendIn && Source.BlendInPresetID == UPlayMontageAdvancedSettings::INVALID_BLEND_IN_PRESET_ID)
+		{
+			TestEqual(FString::Printf(TEXT("%s: quantized BlendTime"), Case.Name), Result.BlendInOverride.Blend.BlendTime,
+				FMath::RoundToFloat(Source.BlendInOverride.Blend.BlendTime * 1000.f) / 1000.f, UE_KINDA_SMALL_NUMBER);
+		}
+
+		AddInfo(FString::Printf(TEXT("%s: %lld bits"), Case.Name, NumBits));
+	}
+
+	return true;
+}
+
+#endif
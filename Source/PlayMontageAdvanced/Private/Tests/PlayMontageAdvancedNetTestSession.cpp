@@ -0,0 +1,201 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+
+#include "PlayMontageAdvancedNetTestSession.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_EDITOR
+
+#include "Editor.h"
+#include "Engine/Engine.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Misc/AutomationTest.h"
+#include "Settings/LevelEditorPlaySettings.h"
+
+namespace PlayMontageAdvancedTests
+{
+
+FNetTestSession::FNetTestSession(FAutomationTestBase& InTest, const FNetTestSessionParams& InParams)
+	: Test(InTest)
+	, Params(InParams)
+{}
+
+void FNetTestSession::QueueStart()
+{
+	TSharedRef<FNetTestSession> Self = AsShared();
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([Self]()
+	{
+		if (!GEditor || GEditor->PlayWorld)
+		{
+			Self->Test.AddError(TEXT("Net test sessions need the editor without a play session in progress"));
+			return true;
+		}
+
+		// The listen server's player counts as one of the players
+		ULevelEditorPlaySettings* PlaySettings = NewObject<ULevelEditorPlaySettings>();
+		PlaySettings->SetPlayNetMode(EPlayNetMode::PIE_ListenServer);
+		PlaySettings->SetPlayNumberOfClients(Self->Params.NumClients + 1);
+		PlaySettings->SetRunUnderOneProcess(true);
+		PlaySettings->bLaunchSeparateServer = false;
+
+		FRequestPlaySessionParams RequestParams;
+		RequestParams.WorldType = EPlaySessionWorldType::PlayInEditor;
+		RequestParams.EditorPlaySettings = PlaySettings;
+		GEditor->RequestPlaySession(RequestParams);
+
+		Self->StartTime = FPlatformTime::Seconds();
+		return true;
+	}));
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([Self]()
+	{
+		if (Self->StartTime == 0.0)
+		{
+			return true;
+		}
+
+		if (!Self->AreClientsConnected())
+		{
+			if (FPlatformTime::Seconds() - Self->StartTime > Self->Params.ConnectTimeout)
+			{
+				Self->Test.AddError(FString::Printf(TEXT("Timed out waiting for %d clients to connect"), Self->Params.NumClients));
+				return true;
+			}
+			return false;
+		}
+
+		Self->ApplyPacketEmulation();
+		Self->bRunning = true;
+		return true;
+	}));
+}
+
+void FNetTestSession::QueueUntil(TFunction<bool()>&& Predicate)
+{
+	TSharedRef<FNetTestSession> Self = AsShared();
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([Self, Predicate = MoveTemp(Predicate)]()
+	{
+		// The play session can be ended from outside the test as well
+		if (!Self->bRunning || !Self->GetServerWorld())
+		{
+			Self->bRunning = false;
+			return true;
+		}
+		return Predicate();
+	}));
+}
+
+void FNetTestSession::QueueWaitFrames(int32 NumFrames)
+{
+	TSharedRef<int32> FramesLeft = MakeShared<int32>(NumFrames);
+	QueueUntil([FramesLeft]()
+	{
+		return --(*FramesLeft) < 0;
+	});
+}
+
+void FNetTestSession::QueueEnd()
+{
+	TSharedRef<FNetTestSession> Self = AsShared();
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([Self]()
+	{
+		Self->bRunning = false;
+		if (GEditor && GEditor->PlayWorld)
+		{
+			GEditor->RequestEndPlayMap();
+		}
+		return true;
+	}));
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([]()
+	{
+		return !GEditor || !GEditor->PlayWorld;
+	}));
+}
+
+UWorld* FNetTestSession::GetServerWorld() const
+{
+	for (const FWorldContext& Context : GEngine->GetWorldContexts())
+	{
+		UWorld* World = Context.World();
+		if (Context.WorldType == EWorldType::PIE && World && World->GetNetMode() == NM_ListenServer)
+		{
+			return World;
+		}
+	}
+	return nullptr;
+}
+
+TArray<UWorld*> FNetTestSession::GetClientWorlds() const
+{
+	TArray<UWorld*> ClientWorlds;
+	for (const FWorldContext& Context : GEngine->GetWorldContexts())
+	{
+		UWorld* World = Context.World();
+		if (Context.WorldType == EWorldType::PIE && World && World->GetNetMode() == NM_Client)
+		{
+			ClientWorlds.Add(World);
+		}
+	}
+	return ClientWorlds;
+}
+
+bool FNetTestSession::AreClientsConnected() const
+{
+	const UWorld* ServerWorld = GetServerWorld();
+	const UNetDriver* ServerNetDriver = ServerWorld ? ServerWorld->GetNetDriver() : nullptr;
+	if (!ServerNetDriver || ServerNetDriver->ClientConnections.Num() < Params.NumClients)
+	{
+		return false;
+	}
+
+	// Clients are in game once their player controller replicated
+	const TArray<UWorld*> ClientWorlds = GetClientWorlds();
+	if (ClientWorlds.Num() < Params.NumClients)
+	{
+		return false;
+	}
+	for (const UWorld* ClientWorld : ClientWorlds)
+	{
+		if (!ClientWorld->GetFirstPlayerController())
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void FNetTestSession::ApplyPacketEmulation() const
+{
+	if (Params.PacketLagMs <= 0 && Params.PacketLossPercent <= 0)
+	{
+		return;
+	}
+
+#if DO_ENABLE_NET_TEST
+	FPacketSimulationSettings Settings;
+	Settings.PktLag = Params.PacketLagMs;
+	Settings.PktLoss = Params.PacketLossPercent;
+
+	TArray<UWorld*> Worlds = GetClientWorlds();
+	Worlds.Add(GetServerWorld());
+	for (UWorld* World : Worlds)
+	{
+		if (UNetDriver* NetDriver = World->GetNetDriver())
+		{
+			NetDriver->SetPacketSimulationSettings(Settings);
+		}
+	}
+#else
+	Test.AddWarning(TEXT("Packet emulation is compiled out of this build, running without lag and loss"));
+#endif
+}
+
+}
+
+#endif
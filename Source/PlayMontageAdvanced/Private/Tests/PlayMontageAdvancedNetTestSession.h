@@ -0,0 +1,69 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_EDITOR
+
+class FAutomationTestBase;
+class UWorld;
+
+namespace PlayMontageAdvancedTests
+{
+	struct FNetTestSessionParams
+	{
+		/** Clients connected to the listen server, not counting the listen server's own player */
+		int32 NumClients = 1;
+
+		/** Latency added to every packet sent, by the server and the clients, in milliseconds */
+		int32 PacketLagMs = 0;
+
+		/** Percentage of packets dropped, by the server and the clients */
+		int32 PacketLossPercent = 0;
+
+		/** Seconds to wait for every client to connect before failing the test */
+		double ConnectTimeout = 60.0;
+	};
+
+	/**
+	 * Runs a PIE listen server with its clients in the same process, driven by latent automation commands
+	 * Commands queued after QueueStart are skipped if the session failed to start
+	 */
+	class FNetTestSession : public TSharedFromThis<FNetTestSession>
+	{
+	public:
+		FNetTestSession(FAutomationTestBase& InTest, const FNetTestSessionParams& InParams);
+
+		/** Queues commands that start the session, wait for every client to connect and apply the packet emulation */
+		void QueueStart();
+
+		/** Queues a command that runs Predicate once per frame until it returns true */
+		void QueueUntil(TFunction<bool()>&& Predicate);
+
+		/** Queues a command that waits for the number of frames */
+		void QueueWaitFrames(int32 NumFrames);
+
+		/** Queues commands that end the session and wait for the play worlds to be torn down */
+		void QueueEnd();
+
+		/** @return True once every client connected, until the session ends */
+		bool IsRunning() const { return bRunning; }
+
+		UWorld* GetServerWorld() const;
+		TArray<UWorld*> GetClientWorlds() const;
+
+		const FNetTestSessionParams& GetParams() const { return Params; }
+
+	protected:
+		FAutomationTestBase& Test;
+		FNetTestSessionParams Params;
+		double StartTime = 0.0;
+		bool bRunning = false;
+
+		bool AreClientsConnected() const;
+		void ApplyPacketEmulation() const;
+	};
+}
+
+#endif
@@ -0,0 +1,133 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_EDITOR
+
+#include "PlayMontageAdvancedNetTestSession.h"
+#include "PlayMontageAdvancedTestTypes.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPlayMontageAdvancedPushModelPerfTest, "PlayMontageAdvanced.Perf.PushModel",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+namespace PushModelPerfTest
+{
+	constexpr int32 NumAvatars = 500;
+	constexpr int32 NumWarmupUpdates = 30;
+	constexpr int32 NumNetUpdates = 300;
+
+	struct FPass
+	{
+		bool bPushModel = false;
+		int32 NumUpdates = 0;
+		uint64 Cycles = 0;
+	};
+}
+
+/**
+ * Compares the server replication time of idle ability system components with the push model off and on
+ * Each pass runs in its own play session, as objects pick up the push model setting when they start replicating
+ */
+bool FPlayMontageAdvancedPushModelPerfTest::RunTest(const FString& Parameters)
+{
+	using namespace PlayMontageAdvancedTests;
+	using namespace PushModelPerfTest;
+
+	IConsoleVariable* PushModelCVar = IConsoleManager::Get().FindConsoleVariable(TEXT("Net.IsPushModelEnabled"));
+	if (!PushModelCVar)
+	{
+		AddWarning(TEXT("Push model is compiled out of this build, nothing to compare"));
+		return true;
+	}
+
+	const bool bWasPushModelEnabled = PushModelCVar->GetBool();
+	TSharedRef<TArray<FPass>> Passes = MakeShared<TArray<FPass>>();
+
+	for (const bool bPushModel : { false, true })
+	{
+		ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([PushModelCVar, bPushModel]()
+		{
+			PushModelCVar->Set(bPushModel, ECVF_SetByCode);
+			return true;
+		}));
+
+		TSharedRef<FNetTestSession> Session = MakeShared<FNetTestSession>(*this, FNetTestSessionParams());
+		Session->QueueStart();
+
+		Session->QueueUntil([this, Session]()
+		{
+			UWorld* ServerWorld = Session->GetServerWorld();
+			for (int32 Index = 0; Index < NumAvatars; Index++)
+			{
+				APlayMontageAdvancedTestAvatar* Avatar = ServerWorld->SpawnActor<APlayMontageAdvancedTestAvatar>();
+				if (!Avatar)
+				{
+					AddError(TEXT("Failed to spawn the test avatars"));
+					break;
+				}
+
+				// Considered for replication on every update
+				Avatar->NetUpdateFrequency = 1000.f;
+				Avatar->MinNetUpdateFrequency = 1000.f;
+			}
+			return true;
+		});
+
+		// Let the initial replication of the avatars settle
+		Session->QueueWaitFrames(NumWarmupUpdates);
+
+		// Replicates once per frame with every avatar due, the net driver's own pass in the frame finds nothing left to send
+		TSharedRef<FPass> Pass = MakeShared<FPass>();
+		Pass->bPushModel = bPushModel;
+		Session->QueueUntil([this, Session, Pass, Passes]()
+		{
+			UWorld* ServerWorld = Session->GetServerWorld();
+			UNetDriver* NetDriver = ServerWorld->GetNetDriver();
+			if (!NetDriver || NetDriver->IsUsingIrisReplication())
+			{
+				AddWarning(TEXT("Iris does not use ServerReplicateActors, nothing to measure"));
+				return true;
+			}
+
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			NetDriver->ServerReplicateActors(ServerWorld->GetDeltaSeconds());
+			Pass->Cycles += FPlatformTime::Cycles64() - StartCycles;
+
+			if (++Pass->NumUpdates < NumNetUpdates)
+			{
+				return false;
+			}
+			Passes->Add(*Pass);
+			return true;
+		});
+
+		Session->QueueEnd();
+	}
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, PushModelCVar, bWasPushModelEnabled, Passes]()
+	{
+		PushModelCVar->Set(bWasPushModelEnabled, ECVF_SetByCode);
+
+		double MsPerUpdate[2] = { 0.0, 0.0 };
+		for (const FPass& Pass : *Passes)
+		{
+			MsPerUpdate[Pass.bPushModel ? 1 : 0] = FPlatformTime::ToMilliseconds64(Pass.Cycles) / FMath::Max(Pass.NumUpdates, 1);
+			AddInfo(FString::Printf(TEXT("Push model %s: %d avatars, %d net updates, %.3f ms per ServerReplicateActors"),
+				Pass.bPushModel ? TEXT("on") : TEXT("off"), NumAvatars, Pass.NumUpdates, MsPerUpdate[Pass.bPushModel ? 1 : 0]));
+		}
+
+		if (Passes->Num() == 2 && MsPerUpdate[1] > 0.0)
+		{
+			AddInfo(FString::Printf(TEXT("Push model off / on: %.2fx"), MsPerUpdate[0] / MsPerUpdate[1]));
+		}
+		return true;
+	}));
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,116 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+
+#include "PlayMontageAdvancedTestTypes.h"
+
+#include "AbilitySystem/AbilityTask_PlayMontageAdvanced.h"
+#include "AbilitySystem/PlayMontageAbilitySystemComponent.h"
+#include "Animation/AnimInstance.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/SkeletalMesh.h"
+#include "Net/UnrealNetwork.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(PlayMontageAdvancedTestTypes)
+
+APlayMontageAdvancedTestAvatar::APlayMontageAdvancedTestAvatar(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	bReplicates = true;
+	bAlwaysRelevant = true;
+
+	Mesh = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("Mesh"));
+	Mesh->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+	SetRootComponent(Mesh);
+
+	AbilitySystem = CreateDefaultSubobject<UPlayMontageAbilitySystemComponent>(TEXT("AbilitySystem"));
+	AbilitySystem->SetIsReplicated(true);
+}
+
+void APlayMontageAdvancedTestAvatar::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ThisClass, SkeletalMesh);
+}
+
+void APlayMontageAdvancedTestAvatar::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	AbilitySystem->InitAbilityActorInfo(this, this);
+}
+
+UAbilitySystemComponent* APlayMontageAdvancedTestAvatar::GetAbilitySystemComponent() const
+{
+	return AbilitySystem;
+}
+
+void APlayMontageAdvancedTestAvatar::SetSkeletalMesh(USkeletalMesh* InSkeletalMesh)
+{
+	SkeletalMesh = InSkeletalMesh;
+	ApplySkeletalMesh();
+}
+
+void APlayMontageAdvancedTestAvatar::OnRep_SkeletalMesh()
+{
+	ApplySkeletalMesh();
+}
+
+void APlayMontageAdvancedTestAvatar::ApplySkeletalMesh()
+{
+	Mesh->SetSkeletalMesh(SkeletalMesh);
+	Mesh->SetAnimInstanceClass(UAnimInstance::StaticClass());
+
+	// The anim instance was replaced, refresh what the ability system caches about the avatar
+	AbilitySystem->InitAbilityActorInfo(this, this);
+}
+
+UPlayMontageAdvancedTestAbility::UPlayMontageAdvancedTestAbility()
+{
+	InstancingPolicy = EGameplayAbilityInstancingPolicy::InstancedPerActor;
+	NetExecutionPolicy = EGameplayAbilityNetExecutionPolicy::ServerOnly;
+}
+
+void UPlayMontageAdvancedTestAbility::ActivateAbility(const FGameplayAbilitySpecHandle Handle,
+	const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilityActivationInfo ActivationInfo,
+	const FGameplayEventData* TriggerEventData)
+{
+	const APlayMontageAdvancedTestAvatar* Avatar = Cast<APlayMontageAdvancedTestAvatar>(ActorInfo->AvatarActor.Get());
+	if (!Avatar || !Avatar->TestMontage || !CommitAbility(Handle, ActorInfo, ActivationInfo))
+	{
+		EndAbility(Handle, ActorInfo, ActivationInfo, true, true);
+		return;
+	}
+
+	FMontageAdvancedParams Params;
+	Params.DriverMontage = Avatar->TestMontage;
+
+	MontageTask = UAbilityTask_PlayMontageAdvanced::CreatePlayMontageAdvancedAndWaitProxy(this, NAME_None, Params,
+		FGameplayTag::EmptyTag, FGameplayTagContainer());
+	MontageTask->OnCompleted.AddDynamic(this, &ThisClass::OnMontageFinished);
+	MontageTask->OnInterrupted.AddDynamic(this, &ThisClass::OnMontageFinished);
+	MontageTask->OnCancelled.AddDynamic(this, &ThisClass::OnMontageFinished);
+	MontageTask->ReadyForActivation();
+}
+
+void UPlayMontageAdvancedTestAbility::EndAbility(const FGameplayAbilitySpecHandle Handle,
+	const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilityActivationInfo ActivationInfo,
+	bool bReplicateEndAbility, bool bWasCancelled)
+{
+	MontageTask = nullptr;
+
+	Super::EndAbility(Handle, ActorInfo, ActivationInfo, bReplicateEndAbility, bWasCancelled);
+}
+
+void UPlayMontageAdvancedTestAbility::SetPlayRate(float InPlayRate)
+{
+	if (MontageTask)
+	{
+		MontageTask->SetPlayRateForMontageGroup(InPlayRate);
+	}
+}
+
+void UPlayMontageAdvancedTestAbility::OnMontageFinished(FGameplayTag EventTag, FGameplayEventData EventData)
+{
+	EndAbility(CurrentSpecHandle, CurrentActorInfo, CurrentActivationInfo, true, false);
+}
@@ -0,0 +1,88 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AbilitySystemInterface.h"
+#include "AbilitySystem/PlayMontageGameplayAbility.h"
+#include "GameFramework/Actor.h"
+#include "PlayMontageAdvancedTestTypes.generated.h"
+
+class UAbilityTask_PlayMontageAdvanced;
+class UAnimMontage;
+class UPlayMontageAbilitySystemComponent;
+class USkeletalMesh;
+class USkeletalMeshComponent;
+
+/**
+ * Replicated avatar with its own ability system component, used by the automation tests
+ * The skeletal mesh is replicated so simulated proxies get an anim instance to play montages on
+ */
+UCLASS(NotPlaceable, NotBlueprintable, HideDropdown, Transient)
+class APlayMontageAdvancedTestAvatar : public AActor, public IAbilitySystemInterface
+{
+	GENERATED_BODY()
+
+public:
+	APlayMontageAdvancedTestAvatar(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual void PostInitializeComponents() override;
+
+	virtual UAbilitySystemComponent* GetAbilitySystemComponent() const override;
+
+	UPlayMontageAbilitySystemComponent* GetPlayMontageAbilitySystem() const { return AbilitySystem; }
+	USkeletalMeshComponent* GetMesh() const { return Mesh; }
+
+	/** Sets the skeletal mesh on the server, simulated proxies follow through replication */
+	void SetSkeletalMesh(USkeletalMesh* InSkeletalMesh);
+
+	/** Montage played by UPlayMontageAdvancedTestAbility, server only */
+	UPROPERTY(Transient)
+	TObjectPtr<UAnimMontage> TestMontage;
+
+protected:
+	UPROPERTY(VisibleAnywhere, Category=Test)
+	TObjectPtr<USkeletalMeshComponent> Mesh;
+
+	UPROPERTY(VisibleAnywhere, Category=Test)
+	TObjectPtr<UPlayMontageAbilitySystemComponent> AbilitySystem;
+
+	UPROPERTY(ReplicatedUsing=OnRep_SkeletalMesh)
+	TObjectPtr<USkeletalMesh> SkeletalMesh;
+
+	UFUNCTION()
+	void OnRep_SkeletalMesh();
+
+	/** Applies SkeletalMesh with a plain anim instance, which is all montages need, and refreshes the actor info */
+	void ApplySkeletalMesh();
+};
+
+/**
+ * Plays the avatar's TestMontage with UAbilityTask_PlayMontageAdvanced on the server, ending once the montage does
+ * Server initiated so simulated proxies receive the montage through RepAnimMontageInfoForMeshes
+ */
+UCLASS(NotBlueprintable, HideDropdown, Transient)
+class UPlayMontageAdvancedTestAbility : public UPlayMontageGameplayAbility
+{
+	GENERATED_BODY()
+
+public:
+	UPlayMontageAdvancedTestAbility();
+
+	virtual void ActivateAbility(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo,
+		const FGameplayAbilityActivationInfo ActivationInfo, const FGameplayEventData* TriggerEventData) override;
+
+	virtual void EndAbility(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo,
+		const FGameplayAbilityActivationInfo ActivationInfo, bool bReplicateEndAbility, bool bWasCancelled) override;
+
+	/** Changes the play rate of the montage being played, simulated proxies have to correct for it */
+	void SetPlayRate(float InPlayRate);
+
+protected:
+	UPROPERTY(Transient)
+	TObjectPtr<UAbilityTask_PlayMontageAdvanced> MontageTask;
+
+	UFUNCTION()
+	void OnMontageFinished(FGameplayTag EventTag, FGameplayEventData EventData);
+};
@@ -0,0 +1,152 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "AbilitySystem/PlayMontageAbilitySystemComponent.h"
+#include "Animation/AnimMontage.h"
+#include "Curves/CurveFloat.h"
+#include "Misc/AutomationTest.h"
+#include "PlayMontageAdvancedSettings.h"
+#include "UObject/CoreNet.h"
+#include "UObject/Package.h"
+
+namespace PlayMontageAdvancedTests
+{
+	/**
+	 * Writes object references as packed indices into a shared table instead of going through a package map
+	 * A packed index costs about what a packed NetGUID does, so the reported bit counts stay representative
+	 */
+	class FObjectTableNetBitWriter : public FNetBitWriter
+	{
+	public:
+		FObjectTableNetBitWriter(TArray<UObject*>& InObjects)
+			: FNetBitWriter(nullptr, 0)
+			, Objects(InObjects)
+		{}
+
+		using FNetBitWriter::operator<<;
+
+		virtual FArchive& operator<<(UObject*& Object) override
+		{
+			uint32 Index = Object ? (uint32)Objects.AddUnique(Object) + 1 : 0;
+			SerializeIntPacked(Index);
+			return *this;
+		}
+
+	private:
+		TArray<UObject*>& Objects;
+	};
+
+	/** Reads object references written by FObjectTableNetBitWriter */
+	class FObjectTableNetBitReader : public FNetBitReader
+	{
+	public:
+		FObjectTableNetBitReader(const TArray<UObject*>& InObjects, const FNetBitWriter& Writer)
+			: FNetBitReader(nullptr, const_cast<uint8*>(Writer.GetData()), Writer.GetNumBits())
+			, Objects(InObjects)
+		{}
+
+		using FNetBitReader::operator<<;
+
+		virtual FArchive& operator<<(UObject*& Object) override
+		{
+			uint32 Index = 0;
+			SerializeIntPacked(Index);
+			Object = Objects.IsValidIndex((int32)Index - 1) ? Objects[Index - 1] : nullptr;
+			return *this;
+		}
+
+	private:
+		const TArray<UObject*>& Objects;
+	};
+
+	struct FRepAnimMontageTestCase
+	{
+		const TCHAR* Name;
+		FPlayTagGameplayAbilityRepAnimMontage RepAnimMontage;
+	};
+
+	/** The entries every serializer test round-trips: no override, a preset, and a full override */
+	inline TArray<FRepAnimMontageTestCase> MakeRepAnimMontageTestCases()
+	{
+		UAnimMontage* Montage = NewObject<UAnimMontage>(GetTransientPackage());
+		UCurveFloat* Curve = NewObject<UCurveFloat>(GetTransientPackage());
+
+		FPlayTagGameplayAbilityRepAnimMontage Base;
+		Base.Animation = Montage;
+		Base.PlayRate = 1.25f;
+		Base.Position = 0.5f;
+		Base.BlendTime = 0.25f;
+		Base.NextSectionID = 2;
+		Base.PlayInstanceId = 3;
+
+		TArray<FRepAnimMontageTestCase> Cases;
+
+		FRepAnimMontageTestCase& NoOverride = Cases.Add_GetRef({ TEXT("NoOverride"), Base });
+		NoOverride.RepAnimMontage.bOverrideBlendIn = false;
+
+		FRepAnimMontageTestCase& Preset = Cases.Add_GetRef({ TEXT("Preset"), Base });
+		Preset.RepAnimMontage.bOverrideBlendIn = true;
+		Preset.RepAnimMontage.BlendInPresetID = 2;
+		Preset.RepAnimMontage.bDeadReckoning = true;
+		Preset.RepAnimMontage.PositionServerTime = 12.5;
+
+		FRepAnimMontageTestCase& FullOverride = Cases.Add_GetRef({ TEXT("FullOverride"), Base });
+		FullOverride.RepAnimMontage.bOverrideBlendIn = true;
+		FullOverride.RepAnimMontage.BlendInPresetID = UPlayMontageAdvancedSettings::INVALID_BLEND_IN_PRESET_ID;
+		FullOverride.RepAnimMontage.BlendInOverride.Blend.BlendTime = 0.2346f;
+		FullOverride.RepAnimMontage.BlendInOverride.Blend.BlendOption = EAlphaBlendOption::Custom;
+		FullOverride.RepAnimMontage.BlendInOverride.Blend.CustomCurve = Curve;
+		FullOverride.RepAnimMontage.BlendInOverride.BlendMode = EMontageBlendMode::Inertialization;
+
+		return Cases;
+	}
+
+	/** Checks that Result holds every field of Source that survives replication */
+	inline void TestRepAnimMontageRoundTrip(FAutomationTestBase& Test, const FString& What,
+		const FPlayTagGameplayAbilityRepAnimMontage& Source, const FPlayTagGameplayAbilityRepAnimMontage& Result)
+	{
+		Test.TestEqual(What + TEXT(": Animation"), Result.Animation.Get(), Source.Animation.Get());
+		Test.TestEqual(What + TEXT(": PlayRate"), Result.PlayRate, Source.PlayRate, 0.01f);
+		Test.TestEqual(What + TEXT(": Position"), Result.Position, Source.Position, 0.01f);
+		Test.TestEqual(What + TEXT(": NextSectionID"), Result.NextSectionID, Source.NextSectionID);
+		Test.TestEqual(What + TEXT(": bOverrideBlendIn"), Result.bOverrideBlendIn, Source.bOverrideBlendIn);
+		Test.TestEqual(What + TEXT(": bDeadReckoning"), Result.bDeadReckoning, Source.bDeadReckoning);
+		Test.TestEqual(What + TEXT(": PositionServerTime"), Result.PositionServerTime, Source.bDeadReckoning ? Source.PositionServerTime : 0.0);
+
+		const bool bUsesPreset = Source.bOverrideBlendIn && Source.BlendInPresetID != UPlayMontageAdvancedSettings::INVALID_BLEND_IN_PRESET_ID;
+		const bool bUsesFullOverride = Source.bOverrideBlendIn && !bUsesPreset;
+		Test.TestEqual(What + TEXT(": BlendInPresetID"), Result.BlendInPresetID,
+			bUsesPreset ? Source.BlendInPresetID : UPlayMontageAdvancedSettings::INVALID_BLEND_IN_PRESET_ID);
+
+		// Unused blend fields come back at their defaults, the full override may quantize its blend time to milliseconds
+		const FMontageBlendSettings Expected = bUsesFullOverride ? Source.BlendInOverride : FMontageBlendSettings();
+		Test.TestEqual(What + TEXT(": BlendTime"), Result.BlendInOverride.Blend.BlendTime, Expected.Blend.BlendTime, 0.0005f + UE_KINDA_SMALL_NUMBER);
+		Test.TestTrue(What + TEXT(": BlendOption"), Result.BlendInOverride.Blend.BlendOption == Expected.Blend.BlendOption);
+		Test.TestTrue(What + TEXT(": BlendMode"), Result.BlendInOverride.BlendMode == Expected.BlendMode);
+		Test.TestEqual(What + TEXT(": CustomCurve"), Result.BlendInOverride.Blend.CustomCurve.Get(), Expected.Blend.CustomCurve.Get());
+		Test.TestEqual(What + TEXT(": BlendProfile"), Result.BlendInOverride.BlendProfile.Get(), Expected.BlendProfile.Get());
+	}
+
+	/** Round-trips the entry through FPlayTagGameplayAbilityRepAnimMontage::NetSerialize, @return Number of bits written */
+	inline int64 RoundTripNetSerialize(const FPlayTagGameplayAbilityRepAnimMontage& Source, FPlayTagGameplayAbilityRepAnimMontage& OutResult, bool& bOutError)
+	{
+		TArray<UObject*> Objects;
+		FObjectTableNetBitWriter Writer(Objects);
+		bool bOutSuccess = true;
+		FPlayTagGameplayAbilityRepAnimMontage WriteCopy = Source;
+		WriteCopy.NetSerialize(Writer, nullptr, bOutSuccess);
+
+		FObjectTableNetBitReader Reader(Objects, Writer);
+		OutResult.NetSerialize(Reader, nullptr, bOutSuccess);
+
+		bOutError = Writer.IsError() || Reader.IsError() || Reader.GetPosBits() != Writer.GetNumBits();
+		return Writer.GetNumBits();
+	}
+}
+
+#endif
@@ -1,4 +1,4 @@
-// Copyright Epic Games, Inc. All Rights Reserved.
+﻿// Copyright Epic Games, Inc. All Rights Reserved.
 #pragma once
 
 #include "CoreMinimal.h"
@@ -169,6 +169,8 @@ public:
 	 * @param bAllowInterruptAfterBlendOut If true, you can receive OnInterrupted after an OnBlendOut started (otherwise OnInterrupted will not fire when interrupted, but you will not get OnComplete).
 	 * @param OverrideBlendOutTimeOnCancelAbility If >= 0 it will override the blend out time when ability is cancelled.
 	 * @param OverrideBlendOutTimeOnEndAbility If >= 0 it will override the blend out time when ability ends.
+	 * @param BlendInPreset If set, use this preset from the project settings instead of BlendInOverride. Only the preset ID is replicated
+	 * @param bReplicateDrivenMontagesAsGroup If true, only the driver montage is replicated along with its driven montages, simulated proxies derive the driven montages from the driver
 	 */
 	UFUNCTION(BlueprintCallable, Category="Ability|Tasks", meta = (DisplayName="PlayMontageAdvancedAndWait",
 		HidePin = "OwningAbility", DefaultToSelf = "OwningAbility", BlueprintInternalUseOnly = "TRUE", MontageTag="MontageTag"))
@@ -180,11 +182,24 @@ public:
 		bool bTriggerNotifiesBeforeStartTimeSeconds = true, bool bDrivenMontagesMatchDriverDuration = true,
 		bool bOverrideBlendIn = false, FMontageBlendSettings BlendInOverride = FMontageBlendSettings(),
 		bool bAllowInterruptAfterBlendOut = false, float OverrideBlendOutTimeOnCancelAbility = -1.f,
-		float OverrideBlendOutTimeOnEndAbility = -1.f);
+		float OverrideBlendOutTimeOnEndAbility = -1.f,
+		UPARAM(meta=(GetOptions="PlayMontageAdvancedSettings.GetBlendInPresetOptions")) FName BlendInPreset = NAME_None,
+		bool bReplicateDrivenMontagesAsGroup = false);
 
 	float PlayDrivenMontageForMesh(UPlayMontageAbilitySystemComponent* ASC, float Duration,
 		const FDrivenMontagePair& Montage, bool bReplicate) const;
 
+	/** Jumps the driver and driven montages started by this task to the section, as a single server RPC */
+	UFUNCTION(BlueprintCallable, Category="Ability|Tasks")
+	void JumpToSectionForMontageGroup(FName SectionName);
+
+	/**
+	 * Sets the play rate of the driver and driven montages started by this task, as a single server RPC
+	 * Driven montages that match the driver duration are scaled accordingly
+	 */
+	UFUNCTION(BlueprintCallable, Category="Ability|Tasks")
+	void SetPlayRateForMontageGroup(float InPlayRate);
+
 	virtual void Activate() override;
 
 	/** Called when the ability is asked to cancel from an outside node. What this means depends on the individual task. By default, this does nothing other than ending the task. */
@@ -198,6 +213,9 @@ protected:
 	/** Checks if the ability is playing a montage and stops that montage, returns true if a montage was stopped, false if not. */
 	bool StopPlayingMontage(float OverrideBlendOutTime = -1.f);
 
+	/** Returns the ASC and the meshes of the driver and driven montages started by this task */
+	UPlayMontageAbilitySystemComponent* GetMontageGroupMeshes(TArray<USkeletalMeshComponent*>& OutMeshes) const;
+
 	void OnGameplayEvent(FGameplayTag EventTag, const FGameplayEventData* Payload);
 	
 	void BroadcastTagEvent(FAnimNotifyByTagEvent& TagEvent) const;
@@ -232,6 +250,9 @@ protected:
 	UPROPERTY()
 	bool bDrivenMontagesMatchDriverDuration;
 
+	UPROPERTY()
+	bool bReplicateDrivenMontagesAsGroup;
+
 	UPROPERTY()
 	bool bTriggerNotifiesBeforeStartTimeSeconds;
 
@@ -244,6 +265,9 @@ protected:
 	UPROPERTY()
 	FMontageBlendSettings BlendInOverride;
 
+	UPROPERTY()
+	FName BlendInPreset;
+
 	UPROPERTY()
 	bool bStopWhenAbilityEnds;
 
@@ -4,11 +4,76 @@
 
 #include "CoreMinimal.h"
 #include "AbilitySystemComponent.h"
+#include "PlayMontageAdvancedTypes.h"
+#include "Net/Serialization/FastArraySerializer.h"
+#include "UObject/ObjectKey.h"
 #include "PlayMontageAbilitySystemComponent.generated.h"
 
+struct FGameplayAbilityRepAnimMontageContainer;
+struct FMontageReplicationLODTier;
+class UPlayMontageAbilitySystemComponent;
+class UNetConnection;
+class UPlayMontageReplicationSubsystem;
+
 // Most of this is from GASShooter and therefore also Copyright 2024 Dan Kestranek.
 // https://github.com/tranek/GASShooter
 
+/**
+ * State of a mesh's current montage, resolved at most once per frame and once more after the mesh's animation update
+ * Montage changes made through the ability system component discard it, other changes are only seen on the next refresh
+ */
+struct FMontageStateSnapshot
+{
+	/** GFrameCounter the snapshot was taken on */
+	uint64 Frame = MAX_uint64;
+
+	/** Whether the mesh's animation had already been updated when the snapshot was taken */
+	bool bPoseTicked = false;
+
+	UAnimInstance* AnimInstance = nullptr;
+
+	UAnimMontage* Montage = nullptr;
+
+	/** True if the montage has an active montage instance, the other values are only set if it does */
+	bool bIsActive = false;
+
+	bool bIsStopped = true;
+
+	float Position = 0.f;
+
+	float PlayRate = 0.f;
+
+	int32 SectionIndex = INDEX_NONE;
+};
+
+/**
+ * Montage state a replicated entry is updated from, computed into the component's staging buffer
+ * Gathering only reads the anim instance, the cached snapshot and the section cache, it never refreshes either cache
+ * The montage replication subsystem gathers these for many components in parallel and commits them on the game thread
+ */
+struct FMontageReplicationGather
+{
+	UAnimInstance* AnimInstance = nullptr;
+
+	UAnimMontage* Montage = nullptr;
+
+	bool bIsStopped = true;
+
+	float Position = 0.f;
+
+	float PlayRate = 0.f;
+
+	float BlendTime = 0.f;
+
+	/** Section at Position and its next section */
+	int32 SectionIndex = INDEX_NONE;
+	int32 NextSectionIndex = INDEX_NONE;
+
+	/** Section at the entry's currently replicated position and its next section, used if the position isn't resampled */
+	int32 RepSectionIndex = INDEX_NONE;
+	int32 RepNextSectionIndex = INDEX_NONE;
+};
+
 /**
  * Data about montages that were played locally (all montages in case of server. predictive montages in case of client). Never replicated directly.
  */
@@ -17,12 +82,26 @@ struct PLAYMONTAGEADVANCED_API FGameplayAbilityLocalAnimMontageForMesh
 {
 	GENERATED_BODY();
 
+	/** Weak so the slot doesn't keep a destroyed mesh around, see UPlayMontageAbilitySystemComponent::PruneStaleMeshEntries */
 	UPROPERTY()
-	USkeletalMeshComponent* Mesh;
+	TWeakObjectPtr<USkeletalMeshComponent> Mesh;
 
 	UPROPERTY()
 	FGameplayAbilityLocalAnimMontage LocalMontageInfo;
 
+	/** Driven montages last derived from this mesh's replicated montage group. Only used by simulated proxies */
+	UPROPERTY()
+	TArray<FDrivenMontagePair> SimulatedDrivenMontages;
+
+	/** Cached by UPlayMontageAbilitySystemComponent::GetMontageStateSnapshot */
+	mutable FMontageStateSnapshot StateSnapshot;
+
+	/** @return True if the slot was pruned and is waiting to be reused for another mesh */
+	bool IsTombstone() const
+	{
+		return Mesh.IsExplicitlyNull();
+	}
+
 	FGameplayAbilityLocalAnimMontageForMesh(USkeletalMeshComponent* InMesh = nullptr)
 		: Mesh(InMesh)
 	{
@@ -34,6 +113,104 @@ struct PLAYMONTAGEADVANCED_API FGameplayAbilityLocalAnimMontageForMesh
 	}
 };
 
+/**
+ * Latest montage control state for a mesh, buffered by the owning client and sent to the server once per frame
+ */
+USTRUCT()
+struct PLAYMONTAGEADVANCED_API FMontageControlForMesh
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	USkeletalMeshComponent* Mesh = nullptr;
+
+	UPROPERTY()
+	UAnimMontage* Montage = nullptr;
+
+	UPROPERTY()
+	bool bSetPlayRate = false;
+
+	UPROPERTY()
+	float PlayRate = 1.f;
+
+	/** Number of flushes this state is still sent on, it is resent in case an unreliable RPC is dropped */
+	UPROPERTY(NotReplicated)
+	uint8 RemainingSends = 0;
+};
+
+/**
+ * Play rate warp a simulated proxy applies to converge on the replicated montage position without snapping
+ */
+USTRUCT()
+struct PLAYMONTAGEADVANCED_API FMontagePositionWarpForMesh
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	USkeletalMeshComponent* Mesh = nullptr;
+
+	UPROPERTY()
+	UAnimMontage* Montage = nullptr;
+
+	/** Play rate restored once the warp completes */
+	UPROPERTY()
+	float BasePlayRate = 1.f;
+
+	UPROPERTY()
+	float TimeRemaining = 0.f;
+};
+
+/**
+ * What caused a montage replay event to be recorded
+ */
+UENUM()
+enum class EMontageReplayEventType : uint8
+{
+	Play,
+	Stop,
+	Section,
+	PlayRate,
+	Position,
+};
+
+/**
+ * Montage state recorded into replays when it changes, replays seek by evaluating it at the current time
+ */
+USTRUCT()
+struct PLAYMONTAGEADVANCED_API FMontageReplayEventForMesh
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	USkeletalMeshComponent* Mesh = nullptr;
+
+	UPROPERTY()
+	UAnimMontage* Montage = nullptr;
+
+	UPROPERTY()
+	EMontageReplayEventType EventType = EMontageReplayEventType::Play;
+
+	/** Server world time the event was recorded at */
+	UPROPERTY()
+	double ServerTime = 0.0;
+
+	UPROPERTY()
+	float Position = 0.f;
+
+	UPROPERTY()
+	float PlayRate = 1.f;
+
+	UPROPERTY()
+	float BlendTime = 0.f;
+
+	/** NextSectionID + 1, zero if there is no next section */
+	UPROPERTY()
+	uint8 NextSectionID = 0;
+
+	UPROPERTY()
+	bool bIsStopped = false;
+};
+
 USTRUCT()
 struct PLAYMONTAGEADVANCED_API FPlayTagGameplayAbilityRepAnimMontage : public FGameplayAbilityRepAnimMontage
 {
@@ -45,13 +222,40 @@ struct PLAYMONTAGEADVANCED_API FPlayTagGameplayAbilityRepAnimMontage : public FG
 	UPROPERTY()
 	FMontageBlendSettings BlendInOverride;
 
+	/** If set, BlendInOverride is not replicated and proxies resolve it from UPlayMontageAdvancedSettings::BlendInPresets */
+	UPROPERTY()
+	uint8 BlendInPresetID;
+
+	/** If true, Position is only replicated on discontinuities and is extrapolated from PositionServerTime */
+	UPROPERTY()
+	bool bDeadReckoning;
+
+	/** Server world time that Position was sampled at, when dead reckoning */
+	UPROPERTY()
+	double PositionServerTime;
+
 	FPlayTagGameplayAbilityRepAnimMontage()
 		: FGameplayAbilityRepAnimMontage()
 		, bOverrideBlendIn(false)
 		, BlendInOverride({})
+		, BlendInPresetID(0)
+		, bDeadReckoning(false)
+		, PositionServerTime(0.0)
 	{}
+
+	/** @return Position extrapolated to ServerTime */
+	float GetDeadReckonedPosition(double ServerTime) const
+	{
+		return Position + (float)(ServerTime - PositionServerTime) * PlayRate;
+	}
 	
 	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+
+	/** @return True if any replicated field differs from Other */
+	bool HasReplicatedChanges(const FPlayTagGameplayAbilityRepAnimMontage& Other) const;
+
+	/** @return True if anything other than the position refresh (Position, BlendTime, PositionServerTime) differs from Other */
+	bool HasReplicatedEventChanges(const FPlayTagGameplayAbilityRepAnimMontage& Other) const;
 };
 
 template<>
@@ -67,7 +271,7 @@ struct TStructOpsTypeTraits<FPlayTagGameplayAbilityRepAnimMontage> : public TStr
  * Data about montages that is replicated to simulated clients.
  */
 USTRUCT()
-struct PLAYMONTAGEADVANCED_API FGameplayAbilityRepAnimMontageForMesh
+struct PLAYMONTAGEADVANCED_API FGameplayAbilityRepAnimMontageForMesh : public FFastArraySerializerItem
 {
 	GENERATED_BODY();
 
@@ -77,10 +281,110 @@ struct PLAYMONTAGEADVANCED_API FGameplayAbilityRepAnimMontageForMesh
 	UPROPERTY()
 	FPlayTagGameplayAbilityRepAnimMontage RepMontageInfo;
 
+	/**
+	 * Montage group driven by this mesh's montage
+	 * These have no replicated entry of their own, simulated proxies derive their position and play rate from this entry
+	 */
+	UPROPERTY()
+	TArray<FDrivenMontagePair> DrivenMontages;
+
+	/** If true, driven montages are scaled to run for the same duration as this montage */
+	UPROPERTY()
+	bool bDrivenMontagesMatchDriverDuration;
+
+	/** Replicated state last applied by this simulated proxy. Not replicated, deserializing the entry leaves it untouched */
+	FPlayTagGameplayAbilityRepAnimMontage LastAppliedRepMontageInfo;
+	TArray<FDrivenMontagePair> LastAppliedDrivenMontages;
+	bool bLastAppliedDrivenMontagesMatchDriverDuration;
+	bool bHasAppliedRepMontageInfo;
+
 	FGameplayAbilityRepAnimMontageForMesh(USkeletalMeshComponent* InMesh = nullptr)
 		: Mesh(InMesh)
+		, bDrivenMontagesMatchDriverDuration(true)
+		, bLastAppliedDrivenMontagesMatchDriverDuration(true)
+		, bHasAppliedRepMontageInfo(false)
 	{
 	}
+
+	/** Caches the replicated state that was just applied */
+	void SetLastApplied(const FPlayTagGameplayAbilityRepAnimMontage& AppliedRepMontageInfo);
+
+	/** @return True if the replicated state is unchanged since it was last applied */
+	bool IsUnchangedSinceLastApplied() const;
+
+	void PreReplicatedRemove(const FGameplayAbilityRepAnimMontageContainer& InArraySerializer);
+	void PostReplicatedAdd(const FGameplayAbilityRepAnimMontageContainer& InArraySerializer);
+	void PostReplicatedChange(const FGameplayAbilityRepAnimMontageContainer& InArraySerializer);
+};
+
+/**
+ * Montage replication LOD state for a single connection, only used by the authority
+ */
+struct FMontageRepConnectionLOD
+{
+	/** EventRevision of the container when it was last sent to this connection */
+	uint32 LastSentEventRevision = 0;
+
+	/** World time the container was last sent to this connection */
+	double LastSentTime = 0.0;
+};
+
+/**
+ * Fast array of FGameplayAbilityRepAnimMontageForMesh
+ * Only the entries that were marked dirty are sent, and simulated proxies only process the entries they received
+ * Connections in a reduced UPlayMontageAdvancedSettings::MontageReplicationLODTiers tier skip position refreshes
+ */
+USTRUCT()
+struct PLAYMONTAGEADVANCED_API FGameplayAbilityRepAnimMontageContainer : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FGameplayAbilityRepAnimMontageForMesh> Items;
+
+	/** Component that owns this container, receives the per-entry callbacks */
+	UPlayMontageAbilitySystemComponent* Owner;
+
+	/** Incremented whenever an entry changes in any way other than a position refresh */
+	uint32 EventRevision;
+
+	/** Size of the last position refresh that was sent, used to estimate the bandwidth saved by skipping them */
+	int64 LastPositionRefreshBits;
+
+	/** Replication LOD state for each connection this container was sent to */
+	TMap<TWeakObjectPtr<UNetConnection>, FMontageRepConnectionLOD> ConnectionLODs;
+
+	/** Cached index of each mesh's item, validated on use since replication adds and removes items on clients */
+	TMap<TObjectKey<USkeletalMeshComponent>, int32> ItemIndices;
+
+	FGameplayAbilityRepAnimMontageContainer()
+		: Owner(nullptr)
+		, EventRevision(0)
+		, LastPositionRefreshBits(0)
+	{}
+
+	/** @return Item for the mesh, nullptr if the mesh's montage isn't replicated */
+	FGameplayAbilityRepAnimMontageForMesh* FindItemForMesh(const USkeletalMeshComponent* InMesh);
+
+	/** Adds an item for the mesh, which must not already have one */
+	FGameplayAbilityRepAnimMontageForMesh& AddItemForMesh(USkeletalMeshComponent* InMesh);
+
+	/** Removes the items of stale meshes, authority only. @return Number of items removed */
+	int32 RemoveStaleItems();
+
+	/** Marks the entry dirty, bPositionRefreshOnly changes can be skipped for connections in a reduced LOD tier */
+	void MarkEntryDirty(FGameplayAbilityRepAnimMontageForMesh& Entry, bool bPositionRefreshOnly = false);
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms);
+};
+
+template<>
+struct TStructOpsTypeTraits<FGameplayAbilityRepAnimMontageContainer> : public TStructOpsTypeTraitsBase2<FGameplayAbilityRepAnimMontageContainer>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
 };
 
 UCLASS(ClassGroup=(AbilitySystem), meta=(BlueprintSpawnableComponent))
@@ -88,13 +392,24 @@ class PLAYMONTAGEADVANCED_API UPlayMontageAbilitySystemComponent : public UAbili
 {
 	GENERATED_BODY()
 
+	friend struct FGameplayAbilityRepAnimMontageForMesh;
+	friend struct FGameplayAbilityRepAnimMontageContainer;
+	friend class UPlayMontageReplicationSubsystem;
+
 public:
+	UPlayMontageAbilitySystemComponent(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);
 
 	virtual bool GetShouldTick() const override;
 
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
+	virtual void InitAbilityActorInfo(AActor* InOwnerActor, AActor* InAvatarActor) override;
+
+	virtual void OnUnregister() override;
+
 public:
 	// ----------------------------------------------------------------------------------------------------------------
 	//	AnimMontage Support for multiple USkeletalMeshComponents on the AvatarActor.
@@ -102,10 +417,12 @@ public:
 	// ----------------------------------------------------------------------------------------------------------------	
 
 	// Plays a montage and handles replication and prediction based on passed in ability/activation info
-	virtual float PlayMontageForMesh(UGameplayAbility* AnimatingAbility, class USkeletalMeshComponent* InMesh, FGameplayAbilityActivationInfo ActivationInfo, UAnimMontage* Montage, float InPlayRate, bool bOverrideBlendIn, const FMontageBlendSettings& BlendInOverride, FName StartSectionName = NAME_None, float StartTimeSeconds = 0.f, bool bReplicateMontage = true);
+	// If BlendInPreset names a preset in UPlayMontageAdvancedSettings it is used instead of BlendInOverride, and only its ID is replicated
+	virtual float PlayMontageForMesh(UGameplayAbility* AnimatingAbility, class USkeletalMeshComponent* InMesh, FGameplayAbilityActivationInfo ActivationInfo, UAnimMontage* Montage, float InPlayRate, bool bOverrideBlendIn, const FMontageBlendSettings& BlendInOverride, FName StartSectionName = NAME_None, float StartTimeSeconds = 0.f, bool bReplicateMontage = true, FName BlendInPreset = NAME_None);
 
 	// Plays a montage without updating replication/prediction structures. Used by simulated proxies when replication tells them to play a montage.
-	virtual float PlayMontageSimulatedForMesh(USkeletalMeshComponent* InMesh, UAnimMontage* Montage, float InPlayRate, bool bOverrideBlendIn, const FMontageBlendSettings& BlendInOverride, float StartTimeSeconds = 0.f, FName StartSectionName = NAME_None);
+	// A valid BlendInPresetID is resolved locally and used instead of BlendInOverride
+	virtual float PlayMontageSimulatedForMesh(USkeletalMeshComponent* InMesh, UAnimMontage* Montage, float InPlayRate, bool bOverrideBlendIn, const FMontageBlendSettings& BlendInOverride, float StartTimeSeconds = 0.f, FName StartSectionName = NAME_None, uint8 BlendInPresetID = 0);
 
 	// Stops whatever montage is currently playing. Expectation is caller should only be stopping it if they are the current animating ability (or have good reason not to check)
 	virtual void CurrentMontageStopForMesh(USkeletalMeshComponent* InMesh, float OverrideBlendOutTime = -1.0f);
@@ -128,6 +445,27 @@ public:
 	// Sets current montage's play rate
 	virtual void CurrentMontageSetPlayRateForMesh(USkeletalMeshComponent* InMesh, float InPlayRate);
 
+	// Jumps the current montage of every mesh to the given section, using a single server RPC and replication update
+	virtual void CurrentMontageJumpToSectionForMeshes(const TArray<USkeletalMeshComponent*>& InMeshes, FName SectionName);
+
+	// Sets the current montage's play rate for every mesh, using a single server RPC and replication update
+	// InPlayRates is either a single rate for every mesh or one rate per mesh
+	virtual void CurrentMontageSetPlayRateForMeshes(const TArray<USkeletalMeshComponent*>& InMeshes, const TArray<float>& InPlayRates);
+
+	// Stops the current montage of every mesh, using a single replication update
+	virtual void CurrentMontageStopForMeshes(const TArray<USkeletalMeshComponent*>& InMeshes, float OverrideBlendOutTime = -1.0f);
+
+	// Call when IsReadyForReplicatedMontageForMesh starts returning true, applies montage rep that arrived before we were ready
+	void NotifyReadyForReplicatedMontage();
+
+	// Defers the avatar's ForceNetUpdate until the outermost batch ends, so changes to several meshes go out in one update
+	void BeginMontageBatch();
+	void EndMontageBatch();
+
+	// Replicates DrivenMontages as a group driven by the montage replicated for DriverMesh, instead of each having their own replicated entry
+	// Simulated proxies derive the position and play rate of each driven montage from the driver. Authority only
+	virtual void SetDrivenMontagesForMesh(USkeletalMeshComponent* DriverMesh, const TArray<FDrivenMontagePair>& DrivenMontages, bool bMatchDriverDuration);
+
 	// Returns true if the passed in ability is the current animating ability
 	bool IsAnimatingAbilityForAnyMesh(const UGameplayAbility* Ability) const;
 
@@ -138,8 +476,56 @@ public:
 	UGameplayAbility* GetAnimatingAbilityFromMesh(USkeletalMeshComponent* InMesh);
 
 	// Returns montages that are currently playing
+	// Allocates the result, per frame callers should use ForEachCurrentMontage or CollectCurrentMontages instead
 	TArray<UAnimMontage*> GetCurrentMontages() const;
 
+	// Calls Visitor(USkeletalMeshComponent* Mesh, UAnimMontage* Montage) for each mesh with a montage playing. Never allocates
+	template<typename VisitorType>
+	void ForEachCurrentMontage(VisitorType&& Visitor) const
+	{
+		for (const TUniquePtr<FGameplayAbilityLocalAnimMontageForMesh>& AnimMontageInfo : LocalAnimMontageInfoForMeshes)
+		{
+			if (AnimMontageInfo->IsTombstone())
+			{
+				continue;
+			}
+
+			const FMontageStateSnapshot& Snapshot = GetMontageStateSnapshot(*AnimMontageInfo);
+			if (Snapshot.bIsActive)
+			{
+				Visitor(AnimMontageInfo->Mesh.Get(), Snapshot.Montage);
+			}
+		}
+	}
+
+	// Replaces the contents of OutMontages with the montages that are currently playing
+	// Only allocates if the caller's buffer is too small, use an inline allocator such as TInlineAllocator<4> to avoid it
+	template<typename AllocatorType>
+	void CollectCurrentMontages(TArray<UAnimMontage*, AllocatorType>& OutMontages) const
+	{
+		OutMontages.Reset();
+		ForEachCurrentMontage([&OutMontages](USkeletalMeshComponent*, UAnimMontage* Montage)
+		{
+			OutMontages.Add(Montage);
+		});
+	}
+
+	// Returns the number of meshes with a montage playing
+	int32 GetNumCurrentMontages() const;
+
+	// Calls Visitor(const FGameplayAbilityLocalAnimMontageForMesh& AnimMontageInfo) for each local montage slot. Never allocates
+	template<typename VisitorType>
+	void ForEachLocalAnimMontageInfo(VisitorType&& Visitor) const
+	{
+		for (const TUniquePtr<FGameplayAbilityLocalAnimMontageForMesh>& AnimMontageInfo : LocalAnimMontageInfoForMeshes)
+		{
+			if (!AnimMontageInfo->IsTombstone())
+			{
+				Visitor(*AnimMontageInfo);
+			}
+		}
+	}
+
 	// Returns the montage that is playing for the mesh
 	UAnimMontage* GetCurrentMontageForMesh(USkeletalMeshComponent* InMesh);
 
@@ -154,6 +540,27 @@ public:
 
 	// Returns amount of time left in current section
 	float GetCurrentMontageSectionTimeLeftForMesh(USkeletalMeshComponent* InMesh);
+
+	// Returns the state of the mesh's current montage for this frame, nullptr if the mesh never played a montage
+	const FMontageStateSnapshot* GetMontageStateSnapshotForMesh(const USkeletalMeshComponent* InMesh) const;
+
+	// Discards the mesh's montage state snapshot
+	// Snapshots are discarded when the anim instance starts or stops a montage and after the mesh evaluates, call this
+	// after changing the montage directly through the anim instance (e.g. Montage_SetPlayRate) to see it immediately
+	void InvalidateMontageStateSnapshotForMesh(const USkeletalMeshComponent* InMesh);
+
+	// Returns true if the mesh was destroyed or unregistered, its entries are then pruned
+	static bool IsStaleMesh(const USkeletalMeshComponent* InMesh);
+
+	// Removes the entries of stale meshes. This happens automatically: stale local slots are reclaimed before a new mesh
+	// grows the slot array, and the server drops stale replicated entries on each replication update. Never during lookups
+	// Call after swapping meshes to release every entry at once. Stale local slots are tombstoned and reused for new meshes,
+	// so references and indices of the other slots stay valid. Returns the number of entries removed
+	int32 PruneStaleMeshEntries();
+
+	// Number of per-mesh entries this component tracks, and the memory they use
+	int32 GetNumMeshEntries() const;
+	SIZE_T GetMeshEntriesAllocatedSize() const;
 	
 protected:
 	// ----------------------------------------------------------------------------------------------------------------
@@ -164,54 +571,296 @@ protected:
 	// Set if montage rep happens while we don't have the AnimInstance associated with us yet
 	UPROPERTY()
 	bool bPendingMontageRepForMesh;
+
+	// If true, montage position is only replicated on discontinuities (start, stop, rate or section changes)
+	// Simulated proxies extrapolate the position from the synchronized server clock in between
+	UPROPERTY(EditDefaultsOnly, Category="Montage Replication")
+	bool bMontageDeadReckoning = false;
+
+	// If true, simulated proxies converge on the replicated position by temporarily changing the montage's play rate
+	// Only errors larger than MontagePositionWarpMaxError snap the position
+	UPROPERTY(EditDefaultsOnly, Category="Montage Replication")
+	bool bMontagePositionWarping = false;
+
+	// Time over which a position error is absorbed by the play rate warp
+	UPROPERTY(EditDefaultsOnly, Category="Montage Replication", meta=(EditCondition="bMontagePositionWarping", ClampMin="0.01", ForceUnits="s"))
+	float MontagePositionWarpDuration = 0.5f;
+
+	// Position errors larger than this snap instead of warping
+	UPROPERTY(EditDefaultsOnly, Category="Montage Replication", meta=(EditCondition="bMontagePositionWarping", ClampMin="0", ForceUnits="s"))
+	float MontagePositionWarpMaxError = 0.5f;
 	
 	// Data structure for montages that were instigated locally (everything if server, predictive if client. replicated if simulated proxy)
 	// Will be max one element per skeletal mesh on the AvatarActor
-	UPROPERTY()
-	TArray<FGameplayAbilityLocalAnimMontageForMesh> LocalAnimMontageInfoForMeshes;
+	// Each slot is allocated on its own and keeps its index, references to a slot stay valid when other meshes get a slot
+	// Slots of stale meshes are tombstoned by PruneStaleMeshEntries and reused for the next mesh that needs one
+	// Not a UPROPERTY, the objects the slots hold are referenced through AddReferencedObjects
+	TArray<TUniquePtr<FGameplayAbilityLocalAnimMontageForMesh>> LocalAnimMontageInfoForMeshes;
+
+	// Index of each mesh's slot in LocalAnimMontageInfoForMeshes
+	TMap<TObjectKey<USkeletalMeshComponent>, int32> LocalAnimMontageSlotIndices;
+
+	// Indices of tombstoned slots in LocalAnimMontageInfoForMeshes, reused before the array grows
+	TArray<int32> FreeLocalAnimMontageSlots;
 	
 	// Data structure for replicating montage info to simulated clients
 	// Will be max one element per skeletal mesh on the AvatarActor
-	UPROPERTY(ReplicatedUsing = OnRep_ReplicatedAnimMontageForMesh)
-	TArray<FGameplayAbilityRepAnimMontageForMesh> RepAnimMontageInfoForMeshes;
+	// Delta replicated, only entries that changed are sent and processed
+	// Push model, must only be modified through FGameplayAbilityRepAnimMontageContainer::MarkEntryDirty
+	UPROPERTY(Replicated)
+	FGameplayAbilityRepAnimMontageContainer RepAnimMontageInfoForMeshes;
+
+	// If true, replays record MontageReplayEvents instead of RepAnimMontageInfoForMeshes
+	// Replays then only receive start, stop, section and play rate changes, and seek without fast-forwarding notifies
+	UPROPERTY(EditDefaultsOnly, Category="Montage Replication")
+	bool bRecordMontageReplayEvents = false;
+
+	// Latest montage replay event for each mesh, only recorded into replays
+	// Each change is a delta in the replay stream, which makes the stream the montage event log
+	UPROPERTY(ReplicatedUsing=OnRep_MontageReplayEvents)
+	TArray<FMontageReplayEventForMesh> MontageReplayEvents;
+
+	// Returns true if a replay is being recorded that MontageReplayEvents should be written to
+	bool IsRecordingMontageReplayEvents() const;
+
+	// Records a montage replay event for the mesh if its montage changed in any way proxies can't extrapolate
+	void RecordMontageReplayEventForMesh(USkeletalMeshComponent* InMesh, UAnimMontage* Montage, UAnimInstance* AnimInstance);
+
+	// Evaluates the montage replay events at the current replay time
+	UFUNCTION()
+	virtual void OnRep_MontageReplayEvents();
+
+	// Seeks the mesh's montage directly to the state described by the replay event
+	void ApplyMontageReplayEvent(const FMontageReplayEventForMesh& ReplayEvent);
+
+	// Returns the index of the mesh's slot in LocalAnimMontageInfoForMeshes, registering one if it doesn't exist
+	int32 RegisterLocalAnimMontageSlotForMesh(USkeletalMeshComponent* InMesh);
+
+	// Tombstones the slots of stale meshes for reuse, other slots are untouched. Returns the number of slots removed
+	int32 PruneStaleLocalAnimMontageSlots();
+
+	// Removes the replicated entries of stale meshes on the server. Returns the number of entries removed
+	// Only call while nothing references RepAnimMontageInfoForMeshes.Items, or the staging buffer indexed by it
+	int32 PruneStaleRepAnimMontageItems();
+
+	// Adds pruned entries to the stats and metrics
+	static void CountPrunedMeshEntries(int32 NumRemoved);
+
+	// Discards the montage state snapshots of every mesh
+	void InvalidateMontageStateSnapshots();
+
+	// Binds to the mesh's and its anim instance's delegates, to discard the snapshots when the montage state changes
+	void BindMontageStateSnapshotInvalidationForMesh(USkeletalMeshComponent* InMesh);
+
+	UFUNCTION()
+	void OnAnimInstanceMontageStarted(UAnimMontage* Montage);
+
+	UFUNCTION()
+	void OnAnimInstanceMontageStopped(UAnimMontage* Montage, bool bInterrupted);
+
+	UFUNCTION()
+	void OnMeshBoneTransformsFinalized();
+
+	UFUNCTION()
+	void OnMeshAnimInitialized();
+
+	// Registers a slot for every skeletal mesh on the avatar up front
+	void RegisterLocalAnimMontageSlotsForAvatar();
 
 	// Finds the existing FGameplayAbilityLocalAnimMontageForMesh for the mesh or creates one if it doesn't exist
 	FGameplayAbilityLocalAnimMontageForMesh& GetLocalAnimMontageInfoForMesh(USkeletalMeshComponent* InMesh);
+	// Finds the existing FGameplayAbilityLocalAnimMontageForMesh for the mesh, nullptr if it doesn't have a slot. Never allocates
+	FGameplayAbilityLocalAnimMontageForMesh* FindLocalAnimMontageInfoForMesh(const USkeletalMeshComponent* InMesh);
+	// Returns the montage last played on the mesh, nullptr if it doesn't have a slot. Never allocates
+	UAnimMontage* FindLocalMontageForMesh(const USkeletalMeshComponent* InMesh);
+
+	// Returns the slot's montage state snapshot, refreshed if it is out of date. Game thread only, the refresh writes the slot
+	const FMontageStateSnapshot& GetMontageStateSnapshot(const FGameplayAbilityLocalAnimMontageForMesh& AnimMontageInfo) const;
+	// Resolves the slot's montage state without caching it. Uses the slot's snapshot if it is up to date, never writes the slot
+	void ComputeMontageStateSnapshot(const FGameplayAbilityLocalAnimMontageForMesh& AnimMontageInfo, FMontageStateSnapshot& OutSnapshot) const;
+
 	// Finds the existing FGameplayAbilityRepAnimMontageForMesh for the mesh or creates one if it doesn't exist
 	FGameplayAbilityRepAnimMontageForMesh& GetGameplayAbilityRepAnimMontageForMesh(USkeletalMeshComponent* InMesh);
+	// Finds the existing FGameplayAbilityRepAnimMontageForMesh for the mesh, nullptr if the mesh's montage isn't replicated
+	FGameplayAbilityRepAnimMontageForMesh* FindGameplayAbilityRepAnimMontageForMesh(USkeletalMeshComponent* InMesh);
 
 	// Called when a prediction key that played a montage is rejected
 	void OnPredictiveMontageRejectedForMesh(USkeletalMeshComponent* InMesh, UAnimMontage* PredictiveMontage);
 
+	// Binds the current prediction key so the montage's section state is restored if the server rejects the section change
+	// Must be called before the section change is applied locally
+	void PredictMontageSectionChangeForMesh(USkeletalMeshComponent* InMesh, UAnimMontage* Montage, UAnimInstance* AnimInstance);
+
+	// Called when a prediction key that jumped or changed the next section of a montage is rejected
+	void OnPredictiveMontageSectionRejectedForMesh(USkeletalMeshComponent* InMesh, UAnimMontage* PredictiveMontage, float PriorPosition, TArray<int32> PriorNextSections, double PredictionWorldTime);
+
+	// Returns true if the server can apply a section change the owning client made to its current montage
+	bool CanApplyClientMontageSectionChangeForMesh(USkeletalMeshComponent* InMesh, UAnimMontage* ClientAnimMontage);
+
+	// Tells the owning client its section change was rejected, accepted changes are acknowledged by the prediction key alone
+	void RejectMontageSectionPrediction(const FPredictionKey& PredictionKey);
+
 	// Copy LocalAnimMontageInfo into RepAnimMontageInfo
 	void AnimMontage_UpdateReplicatedDataForMesh(USkeletalMeshComponent* InMesh);
 	void AnimMontage_UpdateReplicatedDataForMesh(FGameplayAbilityRepAnimMontageForMesh& OutRepAnimMontageInfo);
 
+	// Reads the montage state the entry replicates, returns false if there is nothing to replicate
+	// Only writes OutGather and only reads the section cache, so different components can gather in parallel
+	bool GatherReplicatedDataForMesh(const FGameplayAbilityRepAnimMontageForMesh& RepAnimMontageInfo, FMontageReplicationGather& OutGather) const;
+
+	// Writes the gathered state into the entry, marking it dirty and forcing a net update where needed. Game thread only
+	void CommitReplicatedDataForMesh(FGameplayAbilityRepAnimMontageForMesh& OutRepAnimMontageInfo, const FMontageReplicationGather& Gather);
+
 	// Copy over playing flags for duplicate animation data
 	void AnimMontage_UpdateForcedPlayFlagsForMesh(FGameplayAbilityRepAnimMontageForMesh& OutRepAnimMontageInfo);	
 
+	// Applies every replicated entry, entries are otherwise applied individually as they are received
 	UFUNCTION()
 	virtual void OnRep_ReplicatedAnimMontageForMesh();
 
+	// Applies a single replicated entry to the simulated proxy
+	virtual void OnRep_ReplicatedAnimMontageEntry(FGameplayAbilityRepAnimMontageForMesh& NewRepMontageInfoForMesh);
+
+	// Called when a replicated entry is removed by the server
+	virtual void OnRep_RemovedAnimMontageEntry(const FGameplayAbilityRepAnimMontageForMesh& OldRepMontageInfoForMesh);
+
+	// Derives the driven montages of a replicated montage group from the driver's replicated state
+	void OnRep_DrivenMontagesForMesh(const FGameplayAbilityRepAnimMontageForMesh& DriverRepMontageInfoForMesh, float DriverPosition, float PositionErrorThreshold);
+
+	// Synchronized server clock used for montage dead reckoning
+	double GetMontageServerWorldTime() const;
+
+	// Returns the position the authority is at, extrapolated when the montage is dead reckoned
+	float GetReplicatedMontagePosition(const FPlayTagGameplayAbilityRepAnimMontage& RepMontageInfo) const;
+
 	// Returns true if we are ready to handle replicated montage information
 	virtual bool IsReadyForReplicatedMontageForMesh();
 
+	// Meshes whose montage rep arrived before their AnimInstance or before IsReadyForReplicatedMontageForMesh
+	// Applied once the mesh's anim instance initializes or NotifyReadyForReplicatedMontage is called
+	UPROPERTY()
+	TArray<USkeletalMeshComponent*> PendingMontageRepMeshes;
+
+	void AddPendingMontageRepForMesh(USkeletalMeshComponent* InMesh);
+	void RemovePendingMontageRepForMesh(USkeletalMeshComponent* InMesh);
+
+	// Applies the replicated entries of every pending mesh, meshes that still aren't ready stay pending
+	void ApplyPendingMontageRepForMeshes();
+
+	UFUNCTION()
+	void OnPendingMontageRepMeshAnimInitialized();
+
+	// Meshes that joined a montage in progress but were deferred because the per-frame join budget was spent
+	UPROPERTY()
+	TArray<USkeletalMeshComponent*> PendingMontageJoinMeshes;
+
+	// Applies the replicated entries of deferred montage joins, as far as this frame's join budget allows
+	void ProcessPendingMontageJoins();
+
+	// Returns the montage replication LOD tier used for the connection, nullptr if it receives every update
+	// The owning connection and replays always receive every update
+	virtual const FMontageReplicationLODTier* GetMontageReplicationLODTier(const UNetConnection* Connection) const;
+
+	// Montage control changes waiting to be sent to the server, only the latest state is kept per mesh. Owning client only
+	UPROPERTY()
+	TArray<FMontageControlForMesh> PendingMontageControls;
+
+	// Sequence number of the last montage control update sent (client) or applied (server)
+	uint16 MontageControlSequence = 0;
+
+	// World time of the last montage control flush, flushes are limited to the owner's net update frequency
+	double LastMontageControlFlushTime = 0.0;
+
+	// Finds the buffered control state for the mesh's montage, or starts a new one
+	FMontageControlForMesh& GetPendingMontageControlForMesh(USkeletalMeshComponent* InMesh, UAnimMontage* Montage);
+
+	// Sends the buffered control state to the server in a single unreliable RPC, at most once per net update
+	void FlushPendingMontageControls();
+
+	// Play rate warps in progress on simulated proxies
+	UPROPERTY()
+	TArray<FMontagePositionWarpForMesh> MontagePositionWarps;
+
+	// Absorbs DeltaPosition by warping the montage's play rate, returns false if the error must be snapped instead
+	bool StartMontagePositionWarpForMesh(USkeletalMeshComponent* InMesh, UAnimMontage* Montage, UAnimInstance* AnimInstance, float DeltaPosition);
+
+	// Ends the mesh's warp and restores its play rate
+	void StopMontagePositionWarpForMesh(USkeletalMeshComponent* InMesh);
+
+	// Advances the warps in progress, restoring the play rate of those that completed
+	void UpdateMontagePositionWarps(float DeltaTime);
+
+	// Index in UPlayMontageReplicationSubsystem's registry, INDEX_NONE if not registered
+	int32 MontageReplicationBatchIndex = INDEX_NONE;
+
+	// Returns the world's montage replication subsystem if this component's replicated montages are updated by it
+	UPlayMontageReplicationSubsystem* GetMontageReplicationSubsystem() const;
+
+	// Registers with the montage replication subsystem while a replicated montage is playing
+	void UpdateMontageReplicationBatchRegistration();
+
+	// Refreshes every replicated montage, called by the montage replication subsystem. Returns true while any is playing
+	bool UpdateReplicatedMontagesForBatch();
+
+	// Staging buffer for the montage replication subsystem's parallel pass, one element per replicated entry
+	// Only valid between GatherReplicatedMontagesForBatch and CommitReplicatedMontagesForBatch
+	TArray<FMontageReplicationGather> MontageReplicationStaging;
+	TBitArray<> MontageReplicationStagingValid;
+
+	// Gathers every replicated montage into the staging buffer, may run on a worker thread
+	void GatherReplicatedMontagesForBatch();
+
+	// Commits the staging buffer on the game thread. Returns true while any replicated montage is playing
+	bool CommitReplicatedMontagesForBatch();
+
+	// Depth of nested BeginMontageBatch calls
+	int32 MontageBatchDepth = 0;
+
+	// Set if a net update was requested while batching
+	bool bMontageBatchNetUpdatePending = false;
+
+	// Forces a net update on the avatar actor, or defers it until the current batch ends
+	void ForceMontageNetUpdate();
+
 protected:
 	// RPC function called from CurrentMontageSetNextSectionName, replicates to other clients
 	UFUNCTION(Reliable, Server, WithValidation)
-	void ServerCurrentMontageSetNextSectionNameForMesh(USkeletalMeshComponent* InMesh, UAnimMontage* ClientAnimMontage, float ClientPosition, FName SectionName, FName NextSectionName);
-	void ServerCurrentMontageSetNextSectionNameForMesh_Implementation(USkeletalMeshComponent* InMesh, UAnimMontage* ClientAnimMontage, float ClientPosition, FName SectionName, FName NextSectionName);
-	bool ServerCurrentMontageSetNextSectionNameForMesh_Validate(USkeletalMeshComponent* InMesh, UAnimMontage* ClientAnimMontage, float ClientPosition, FName SectionName, FName NextSectionName);
+	void ServerCurrentMontageSetNextSectionNameForMesh(USkeletalMeshComponent* InMesh, UAnimMontage* ClientAnimMontage, float ClientPosition, FName SectionName, FName NextSectionName, FPredictionKey PredictionKey);
+	void ServerCurrentMontageSetNextSectionNameForMesh_Implementation(USkeletalMeshComponent* InMesh, UAnimMontage* ClientAnimMontage, float ClientPosition, FName SectionName, FName NextSectionName, FPredictionKey PredictionKey);
+	bool ServerCurrentMontageSetNextSectionNameForMesh_Validate(USkeletalMeshComponent* InMesh, UAnimMontage* ClientAnimMontage, float ClientPosition, FName SectionName, FName NextSectionName, FPredictionKey PredictionKey);
 
 	// RPC function called from CurrentMontageJumpToSection, replicates to other clients
 	UFUNCTION(Reliable, Server, WithValidation)
-	void ServerCurrentMontageJumpToSectionNameForMesh(USkeletalMeshComponent* InMesh, UAnimMontage* ClientAnimMontage, FName SectionName);
-	void ServerCurrentMontageJumpToSectionNameForMesh_Implementation(USkeletalMeshComponent* InMesh, UAnimMontage* ClientAnimMontage, FName SectionName);
-	bool ServerCurrentMontageJumpToSectionNameForMesh_Validate(USkeletalMeshComponent* InMesh, UAnimMontage* ClientAnimMontage, FName SectionName);
+	void ServerCurrentMontageJumpToSectionNameForMesh(USkeletalMeshComponent* InMesh, UAnimMontage* ClientAnimMontage, FName SectionName, FPredictionKey PredictionKey);
+	void ServerCurrentMontageJumpToSectionNameForMesh_Implementation(USkeletalMeshComponent* InMesh, UAnimMontage* ClientAnimMontage, FName SectionName, FPredictionKey PredictionKey);
+	bool ServerCurrentMontageJumpToSectionNameForMesh_Validate(USkeletalMeshComponent* InMesh, UAnimMontage* ClientAnimMontage, FName SectionName, FPredictionKey PredictionKey);
 
 	// RPC function called from CurrentMontageSetPlayRate, replicates to other clients
 	UFUNCTION(Reliable, Server, WithValidation)
 	void ServerCurrentMontageSetPlayRateForMesh(USkeletalMeshComponent* InMesh, UAnimMontage* ClientAnimMontage, float InPlayRate);
 	void ServerCurrentMontageSetPlayRateForMesh_Implementation(USkeletalMeshComponent* InMesh, UAnimMontage* ClientAnimMontage, float InPlayRate);
 	bool ServerCurrentMontageSetPlayRateForMesh_Validate(USkeletalMeshComponent* InMesh, UAnimMontage* ClientAnimMontage, float InPlayRate);
+
+	// RPC function called from CurrentMontageJumpToSectionForMeshes, replicates to other clients
+	UFUNCTION(Reliable, Server, WithValidation)
+	void ServerCurrentMontageJumpToSectionNameForMeshes(const TArray<USkeletalMeshComponent*>& InMeshes, const TArray<UAnimMontage*>& ClientAnimMontages, FName SectionName, FPredictionKey PredictionKey);
+	void ServerCurrentMontageJumpToSectionNameForMeshes_Implementation(const TArray<USkeletalMeshComponent*>& InMeshes, const TArray<UAnimMontage*>& ClientAnimMontages, FName SectionName, FPredictionKey PredictionKey);
+	bool ServerCurrentMontageJumpToSectionNameForMeshes_Validate(const TArray<USkeletalMeshComponent*>& InMeshes, const TArray<UAnimMontage*>& ClientAnimMontages, FName SectionName, FPredictionKey PredictionKey);
+
+	// RPC function called from CurrentMontageSetPlayRateForMeshes, replicates to other clients
+	UFUNCTION(Reliable, Server, WithValidation)
+	void ServerCurrentMontageSetPlayRateForMeshes(const TArray<USkeletalMeshComponent*>& InMeshes, const TArray<UAnimMontage*>& ClientAnimMontages, const TArray<float>& InPlayRates);
+	void ServerCurrentMontageSetPlayRateForMeshes_Implementation(const TArray<USkeletalMeshComponent*>& InMeshes, const TArray<UAnimMontage*>& ClientAnimMontages, const TArray<float>& InPlayRates);
+	bool ServerCurrentMontageSetPlayRateForMeshes_Validate(const TArray<USkeletalMeshComponent*>& InMeshes, const TArray<UAnimMontage*>& ClientAnimMontages, const TArray<float>& InPlayRates);
+
+	// Called by the server when a predicted section jump or next section change is rejected
+	UFUNCTION(Client, Reliable)
+	void ClientMontageSectionPredictionRejected(int16 PredictionKeyId);
+	void ClientMontageSectionPredictionRejected_Implementation(int16 PredictionKeyId);
+
+	// RPC function called from FlushPendingMontageControls, out of date sequences are ignored
+	UFUNCTION(Unreliable, Server, WithValidation)
+	void ServerUpdateMontageControlsForMesh(const TArray<FMontageControlForMesh>& Controls, uint16 Sequence);
+	void ServerUpdateMontageControlsForMesh_Implementation(const TArray<FMontageControlForMesh>& Controls, uint16 Sequence);
+	bool ServerUpdateMontageControlsForMesh_Validate(const TArray<FMontageControlForMesh>& Controls, uint16 Sequence);
 };
@@ -15,7 +15,7 @@ struct PLAYMONTAGEADVANCED_API FAbilityMeshMontage
 	GENERATED_BODY()
 
 	UPROPERTY()
-	USkeletalMeshComponent* Mesh;
+	TWeakObjectPtr<USkeletalMeshComponent> Mesh;
 
 	UPROPERTY()
 	UAnimMontage* Montage;
@@ -40,10 +40,22 @@ public:
 	//	Animation Support for multiple USkeletalMeshComponents on the AvatarActor
 	// ----------------------------------------------------------------------------------------------------------------
 
-	/** Active montages being played by this ability */
-	UPROPERTY()
-	TArray<FAbilityMeshMontage> CurrentAbilityMeshMontages;
+	/** Typical number of meshes an ability plays montages on, more spill onto the heap */
+	static constexpr int32 NumInlineAbilityMeshMontages = 6;
+
+	/**
+	 * Active montages being played by this ability, at most one entry per mesh
+	 * Not a UPROPERTY so it can use inline storage, montages are referenced through AddReferencedObjects
+	 */
+	TArray<FAbilityMeshMontage, TInlineAllocator<NumInlineAbilityMeshMontages>> CurrentAbilityMeshMontages;
+
+	static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);
 
+	/** Returns the mesh's entry so it can be updated in place, nullptr if the ability didn't play a montage on it */
+	FAbilityMeshMontage* FindAbilityMeshMontage(const USkeletalMeshComponent* InMesh);
+	const FAbilityMeshMontage* FindAbilityMeshMontage(const USkeletalMeshComponent* InMesh) const;
+
+	/** Copies the mesh's entry into InAbilityMontage, use the pointer overload to update it in place */
 	bool FindAbilityMeshMontage(USkeletalMeshComponent* InMesh, FAbilityMeshMontage& InAbilityMontage);
 	
 	/** Returns the currently playing montage for this ability, if any */
@@ -53,4 +65,7 @@ public:
 	/** Call to set/get the current montage from a montage task. Set to allow hooking up montage events to ability events */
 	virtual void SetCurrentMontageForMesh(USkeletalMeshComponent* InMesh, class UAnimMontage* InCurrentMontage);
 
+	/** Clears the current montage of every mesh at once, called when the ability stops animating */
+	virtual void ClearCurrentMontagesForAllMeshes();
+
 };
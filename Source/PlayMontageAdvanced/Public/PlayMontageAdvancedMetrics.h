@@ -0,0 +1,49 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Montage replication counters accumulated since the last reset
+ * Unlike stats these are available in shipping and test builds, so replication cost can be compared between builds
+ * Dump with PlayMontageAdvanced.Metrics.Dump [Filename], reset with PlayMontageAdvanced.Metrics.Reset
+ */
+struct PLAYMONTAGEADVANCED_API FPlayMontageAdvancedMetrics
+{
+	/** Bytes written by RepAnimMontageInfoForMeshes delta serialization, across all connections */
+	uint64 ReplicatedBytes = 0;
+
+	/** Number of delta serializations of RepAnimMontageInfoForMeshes that sent data */
+	uint64 ReplicatedUpdates = 0;
+
+	/** Montage RPCs sent, server and client */
+	uint64 RPCs = 0;
+
+	/** Replicated entries applied and skipped by simulated proxies */
+	uint64 AppliedEntries = 0;
+	uint64 SkippedEntries = 0;
+
+	/** Position corrections made by simulated proxies */
+	uint64 PositionSnaps = 0;
+	uint64 PositionWarps = 0;
+
+	/** Predicted section changes rejected by the server */
+	uint64 SectionPredictionRejections = 0;
+
+	/** Per-mesh entries removed because their mesh was destroyed or unregistered */
+	uint64 PrunedMeshEntries = 0;
+
+	/** Platform time the counters were last reset at */
+	double StartTime = FPlatformTime::Seconds();
+
+	static FPlayMontageAdvancedMetrics& Get();
+
+	void Reset();
+
+	/** @return Counters and per second rates as a JSON object */
+	FString ToJson() const;
+
+	/** Writes ToJson to Filename, relative paths are relative to the profiling directory */
+	bool WriteToFile(const FString& Filename) const;
+};
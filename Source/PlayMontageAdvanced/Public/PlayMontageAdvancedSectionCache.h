@@ -0,0 +1,86 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UAnimMontage;
+
+/**
+ * Immutable section metadata for a montage, built once per asset and shared by every ability system component and task
+ * Replaces the linear scans over CompositeSections done by UAnimMontage::GetSectionIndexFromPosition and friends
+ */
+struct PLAYMONTAGEADVANCED_API FMontageSectionCache
+{
+	/** Section start times, ascending when bSortedStartTimes */
+	TArray<float> StartTimes;
+
+	/** Time from each section's start to the next section or the end of the montage */
+	TArray<float> Lengths;
+
+	TArray<FName> Names;
+
+	TMap<FName, int32> NameToIndex;
+
+	float PlayLength = 0.f;
+
+	/** False if the montage's sections aren't ordered by time, lookups by position then use the montage directly */
+	bool bSortedStartTimes = true;
+
+	/**
+	 * Returns the cache for the montage, building it on first use. Returns an empty cache for a null montage
+	 * Don't keep the reference past the current frame, caches are discarded when their montage is modified or collected
+	 */
+	static const FMontageSectionCache& Get(const UAnimMontage* Montage);
+
+	/**
+	 * Returns the montage's cache if it was already built, nullptr otherwise. Only takes the read lock, safe on worker threads
+	 * Montages are cached on the game thread when they are played, see UPlayMontageAbilitySystemComponent::PlayMontageForMesh
+	 */
+	static const FMontageSectionCache* Find(const UAnimMontage* Montage);
+
+	/** Same as GetSectionIndexFromPosition, but never builds the cache and uses the montage directly if it isn't cached */
+	static int32 FindSectionIndexFromPosition(const UAnimMontage* Montage, float Position);
+
+	/** Discards the montage's cache, it is rebuilt on next use */
+	static void Invalidate(const UAnimMontage* Montage);
+
+	/** Discards every cache, they are rebuilt on next use */
+	static void Flush();
+
+	/** Discards the caches of montages that were garbage collected */
+	static void Prune();
+
+	/** Same result as UAnimMontage::GetSectionIndexFromPosition, using a binary search */
+	int32 GetSectionIndexFromPosition(float Position) const;
+
+	/** Same result as UAnimMontage::GetSectionIndex */
+	int32 GetSectionIndex(FName SectionName) const
+	{
+		const int32* SectionIndex = NameToIndex.Find(SectionName);
+		return SectionIndex ? *SectionIndex : INDEX_NONE;
+	}
+
+	FName GetSectionName(int32 SectionIndex) const
+	{
+		return Names.IsValidIndex(SectionIndex) ? Names[SectionIndex] : NAME_None;
+	}
+
+	float GetSectionStartTime(int32 SectionIndex) const
+	{
+		return StartTimes.IsValidIndex(SectionIndex) ? StartTimes[SectionIndex] : 0.f;
+	}
+
+	float GetSectionLength(int32 SectionIndex) const
+	{
+		return Lengths.IsValidIndex(SectionIndex) ? Lengths[SectionIndex] : 0.f;
+	}
+
+	/** Same result as UAnimMontage::GetSectionTimeLeftFromPos */
+	float GetSectionTimeLeftFromPosition(float Position) const;
+
+private:
+	const UAnimMontage* SourceMontage = nullptr;
+
+	void Build(const UAnimMontage* Montage);
+};
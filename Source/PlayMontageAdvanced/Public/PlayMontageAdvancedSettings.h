@@ -0,0 +1,96 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DeveloperSettings.h"
+#include "Animation/AnimMontage.h"
+#include "PlayMontageAdvancedSettings.generated.h"
+
+/**
+ * Named blend-in settings that can be replicated as a small ID instead of the full FMontageBlendSettings
+ */
+USTRUCT(BlueprintType)
+struct PLAYMONTAGEADVANCED_API FMontageBlendInPreset
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Montage)
+	FName Name;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Montage)
+	FMontageBlendSettings BlendSettings;
+};
+
+/**
+ * Montage replication LOD tier, selected per connection by the distance from its view target to the avatar
+ */
+USTRUCT(BlueprintType)
+struct PLAYMONTAGEADVANCED_API FMontageReplicationLODTier
+{
+	GENERATED_BODY()
+
+	/** Connections viewing from at least this far away use this tier. Divided by the owner's NetPriority */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Montage, meta=(ClampMin="0", ForceUnits="cm"))
+	float MinDistance = 0.f;
+
+	/**
+	 * Minimum time between position refreshes sent to connections in this tier
+	 * Start, stop, section and play rate changes are always sent immediately
+	 * If negative, position refreshes are never sent
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Montage, meta=(ForceUnits="s"))
+	float PositionRefreshInterval = -1.f;
+};
+
+/**
+ * Project settings for PlayMontageAdvanced
+ */
+UCLASS(Config=Game, DefaultConfig, meta=(DisplayName="Play Montage Advanced"))
+class PLAYMONTAGEADVANCED_API UPlayMontageAdvancedSettings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+
+public:
+	/** ID replicated when no preset is used */
+	static constexpr uint8 INVALID_BLEND_IN_PRESET_ID = 0;
+
+	/**
+	 * Blend-in presets that can be used instead of passing FMontageBlendSettings
+	 * Only the preset ID is replicated, so the order must match between server and clients
+	 */
+	UPROPERTY(Config, EditAnywhere, Category=Replication, meta=(TitleProperty="Name"))
+	TArray<FMontageBlendInPreset> BlendInPresets;
+
+	/** @return ID for the preset, or INVALID_BLEND_IN_PRESET_ID if no preset with that name exists */
+	uint8 GetBlendInPresetID(FName PresetName) const;
+
+	/** @return Blend settings for the preset, or nullptr if the ID is invalid */
+	const FMontageBlendSettings* GetBlendInPreset(uint8 PresetID) const;
+
+	/** Used to populate dropdowns for blend-in preset names */
+	UFUNCTION()
+	static TArray<FName> GetBlendInPresetOptions();
+
+	/** If true, connections that are far from the avatar receive fewer montage position refreshes */
+	UPROPERTY(Config, EditAnywhere, Category=Replication)
+	bool bEnableMontageReplicationLOD = false;
+
+	/** Montage replication LOD tiers, connections closer than every tier's MinDistance receive every update */
+	UPROPERTY(Config, EditAnywhere, Category=Replication, meta=(EditCondition="bEnableMontageReplicationLOD"))
+	TArray<FMontageReplicationLODTier> MontageReplicationLODTiers;
+
+	/** @return Farthest tier that Distance reaches, or nullptr if it receives every update */
+	const FMontageReplicationLODTier* GetMontageReplicationLODTier(float Distance) const;
+
+	/**
+	 * If true, UPlayMontageReplicationSubsystem refreshes the replicated montage data of every authoritative component
+	 * in one pass per frame, instead of each component ticking to do so
+	 */
+	UPROPERTY(Config, EditAnywhere, Category=Replication)
+	bool bBatchMontageReplicationUpdates = false;
+
+#if WITH_EDITOR
+	virtual FText GetSectionText() const override;
+#endif
+};
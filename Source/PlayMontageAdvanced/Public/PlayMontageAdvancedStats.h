@@ -0,0 +1,29 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("PlayMontageAdvanced"), STATGROUP_PlayMontageAdvanced, STATCAT_Advanced);
+
+// Montage replication LOD
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Montage Rep LOD Full Rate Sends"), STAT_MontageRepLOD_FullRateSends, STATGROUP_PlayMontageAdvanced, PLAYMONTAGEADVANCED_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Montage Rep LOD Reduced Rate Sends"), STAT_MontageRepLOD_ReducedRateSends, STATGROUP_PlayMontageAdvanced, PLAYMONTAGEADVANCED_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Montage Rep LOD Skipped Refreshes"), STAT_MontageRepLOD_SkippedRefreshes, STATGROUP_PlayMontageAdvanced, PLAYMONTAGEADVANCED_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Montage Rep LOD Bytes Saved (Estimated)"), STAT_MontageRepLOD_BytesSaved, STATGROUP_PlayMontageAdvanced, PLAYMONTAGEADVANCED_API);
+
+// Simulated proxy montage rep
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Montage Rep Applied Entries"), STAT_MontageRep_AppliedEntries, STATGROUP_PlayMontageAdvanced, PLAYMONTAGEADVANCED_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Montage Rep Skipped Entries"), STAT_MontageRep_SkippedEntries, STATGROUP_PlayMontageAdvanced, PLAYMONTAGEADVANCED_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Montage Rep Position Snaps"), STAT_MontageRep_PositionSnaps, STATGROUP_PlayMontageAdvanced, PLAYMONTAGEADVANCED_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Montage Rep Position Warps"), STAT_MontageRep_PositionWarps, STATGROUP_PlayMontageAdvanced, PLAYMONTAGEADVANCED_API);
+
+// Batched montage replication
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Montage Rep Batch Components"), STAT_MontageRepBatch_Components, STATGROUP_PlayMontageAdvanced, PLAYMONTAGEADVANCED_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Montage Rep Batch Serial"), STAT_MontageRepBatch_Serial, STATGROUP_PlayMontageAdvanced, PLAYMONTAGEADVANCED_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Montage Rep Batch Gather"), STAT_MontageRepBatch_Gather, STATGROUP_PlayMontageAdvanced, PLAYMONTAGEADVANCED_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Montage Rep Batch Commit"), STAT_MontageRepBatch_Commit, STATGROUP_PlayMontageAdvanced, PLAYMONTAGEADVANCED_API);
+
+// Per-mesh entries, see PlayMontageAdvanced.DumpMeshEntries for the entries held by each component
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Montage Mesh Entries Pruned"), STAT_MontageMeshEntries_Pruned, STATGROUP_PlayMontageAdvanced, PLAYMONTAGEADVANCED_API);
@@ -0,0 +1,44 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "PlayMontageReplicationSubsystem.generated.h"
+
+class UPlayMontageAbilitySystemComponent;
+
+/**
+ * Refreshes the replicated montage data of every authoritative ability system component with a playing montage
+ * in a single pass per frame, instead of each component ticking to do so
+ * Components with nothing else to tick for stop ticking entirely
+ * With enough components the montage state is gathered in parallel, then committed on the game thread
+ * Opt-in with UPlayMontageAdvancedSettings::bBatchMontageReplicationUpdates
+ */
+UCLASS()
+class PLAYMONTAGEADVANCED_API UPlayMontageReplicationSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool IsTickable() const override { return Components.Num() > 0; }
+
+	/** Adds the component to the next pass, it is removed once none of its replicated montages are playing */
+	void RegisterComponent(UPlayMontageAbilitySystemComponent* Component);
+
+	void UnregisterComponent(UPlayMontageAbilitySystemComponent* Component);
+
+	int32 GetNumRegisteredComponents() const { return Components.Num(); }
+
+protected:
+	/** Components to update, each stores its index for constant time removal */
+	UPROPERTY()
+	TArray<TObjectPtr<UPlayMontageAbilitySystemComponent>> Components;
+
+	void RemoveComponentAt(int32 Index);
+};
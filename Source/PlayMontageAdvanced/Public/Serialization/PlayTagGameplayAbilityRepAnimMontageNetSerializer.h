@@ -0,0 +1,50 @@
+// Copyright (c) Jared Taylor. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Abilities/GameplayAbilityRepAnimMontage.h"
+#include "Animation/AnimMontage.h"
+#include "Iris/Serialization/NetSerializer.h"
+#include "PlayTagGameplayAbilityRepAnimMontageNetSerializer.generated.h"
+
+/**
+ * Iris replicated representation of FPlayTagGameplayAbilityRepAnimMontage
+ * The base montage state is replicated with the serializer registered for FGameplayAbilityRepAnimMontage
+ */
+USTRUCT()
+struct FPlayTagGameplayAbilityRepAnimMontageForNetSerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FGameplayAbilityRepAnimMontage RepAnimMontage;
+
+	UPROPERTY()
+	bool bOverrideBlendIn = false;
+
+	/** Left at its defaults when a preset or no override is used, so it costs nothing to replicate */
+	UPROPERTY()
+	FMontageBlendSettings BlendInOverride;
+
+	UPROPERTY()
+	uint8 BlendInPresetID = 0;
+
+	UPROPERTY()
+	bool bDeadReckoning = false;
+
+	/** Zero unless dead reckoning */
+	UPROPERTY()
+	double PositionServerTime = 0.0;
+};
+
+USTRUCT()
+struct FPlayTagGameplayAbilityRepAnimMontageNetSerializerConfig : public FNetSerializerConfig
+{
+	GENERATED_BODY()
+};
+
+namespace UE::Net
+{
+	UE_NET_DECLARE_SERIALIZER(FPlayTagGameplayAbilityRepAnimMontageNetSerializer, PLAYMONTAGEADVANCED_API);
+}